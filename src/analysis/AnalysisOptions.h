@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+namespace smacpp {
+
+//! \brief Settings for an analysis run, set from the plugin arguments
+struct AnalysisOptions {
+    //! Enables debug printing
+    bool Debug = false;
+
+    //! Explores paths depth first instead of queueing analysis operations
+    bool DepthFirst = false;
+
+    //! Lowers the CodeBlocks to SSA form which the queue based analysis then uses. The SSA
+    //! form doesn't fork, unknown conditions are treated as false and the fork limits below
+    //! don't apply
+    bool SSA = false;
+
+    //! Number of threads the queue based analysis runs on
+    size_t Jobs = 1;
+
+    //! How many unknown conditions a single path can fork on
+    size_t ForkDepthLimit = 16;
+
+    //! How many forks on unknown conditions the analysis of a single function call can make
+    size_t PathBudget = 1024;
+
+    //! How many distinct parameter tuples a function is analysed with before widening, 0
+    //! disables the limit. Which tuples get analysed exactly depends on the order the calls
+    //! are found in, so with more than one job the queue based analysis needs this disabled
+    //! for the report to not depend on the thread timing
+    size_t ContextLimit = 64;
+
+    //! Summarises the functions main can reach bottom up over the call graph before the
+    //! analysis from main, which then reuses the summaries
+    bool BottomUp = false;
+};
+
+} // namespace smacpp
@@ -2,10 +2,22 @@
 #include "Analyzer.h"
 
 #include "BlockRegistry.h"
+#include "EvaluationMemo.h"
+#include "FunctionSummary.h"
 #include "parse/CodeBlock.h"
+#include "parse/ConditionArena.h"
 #include "parse/ProcessedAction.h"
+#include "parse/SSAForm.h"
 
+#include "WorkerQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 // DEBUGGING CODE
 #include <iostream>
@@ -33,91 +45,175 @@ std::string FoundProblem::FormatAsString() const
     // TODO: printing Location here needs a clang SourceManager reference
     return sstream.str();
 }
+
+bool FoundProblem::operator<(const FoundProblem& other) const
+{
+    if(Location.getRawEncoding() != other.Location.getRawEncoding())
+        return Location.getRawEncoding() < other.Location.getRawEncoding();
+
+    if(Message != other.Message)
+        return Message < other.Message;
+
+    return Severity < other.Severity;
+}
 // ------------------------------------ //
 // ProgramState
+ProgramState::ProgramState(const CodeBlock* frame) : Frame(frame) {}
+// ------------------------------------ //
+const VariableState* ProgramState::Find(const VariableIdentifier& variable) const
+{
+    if(IsFrameVariable(variable))
+        return Slots.Find(SymbolTable::Get().GetFrameSlot(variable.ID));
+
+    return Globals.Find(variable.ID);
+}
+
+void ProgramState::Store(const VariableIdentifier& variable, VariableState state)
+{
+    // Copies and computations are resolved when stored, this gives the value semantics of
+    // C assignment and means that reads never need to follow a chain of copies
+    if(state.State == VariableState::STATE::CopyVar ||
+        state.State == VariableState::STATE::Compute)
+        state = state.Resolve(*this);
+
+    const bool global = !IsFrameVariable(variable);
+
+    if(RecordTrail)
+        Trail.push_back(TrailEntry{global, global ? Globals : Slots, Versions});
+
+    Versions.Set(variable.ID, ++Version);
+
+    if(!global) {
+        Slots.Set(SymbolTable::Get().GetFrameSlot(variable.ID), state);
+    } else {
+        Globals.Set(variable.ID, state);
+    }
+}
+
+bool ProgramState::IsFrameVariable(const VariableIdentifier& variable) const
+{
+    if(!Frame)
+        return false;
+
+    const auto slot = SymbolTable::Get().GetFrameSlot(variable.ID);
+
+    // The slot needs to be checked to be for this frame as it is from the global table
+    return slot < Frame->GetFrameSize() && Frame->GetFrameSlots()[slot] == variable;
+}
+// ------------------------------------ //
 void ProgramState::CreateLocal(VariableIdentifier identifier, VariableState initialState)
 {
     // TODO: allow shadowing globals and locals defined in upper scope
-    Variables[identifier] = initialState;
+    Store(identifier, initialState);
 }
 
 void ProgramState::Assign(VariableIdentifier identifier, VariableState state)
 {
-    Variables[identifier] = state;
+    Store(identifier, state);
 }
 // ------------------------------------ //
-bool ProgramState::MatchesCondition(const Condition& condition) const
+TRI_STATE ProgramState::MatchesCondition(const Condition& condition) const
 {
     return condition.Evaluate(*this);
 }
 
-VariableState ProgramState::GetVariableValue(const VariableIdentifier& variable) const
+void ProgramState::Assume(const Condition& condition, bool value)
 {
-    const auto found = Variables.find(variable);
+    std::vector<std::tuple<VariableIdentifier, ValueRange>> implied;
+    ConditionArena::Get().CollectImpliedRanges(condition.GetNodeID(), value, implied);
 
-    if(found == Variables.end()) {
-        return VariableState();
-    }
+    for(const auto& [variable, range] : implied) {
+        const auto current = GetVariableValue(variable);
+        const auto refined = range.Refine(current, *this);
 
-    try {
-        return found->second.Resolve(*this);
-    } catch(const UnknownVariableStateException& e) {
-        // if(Debug)
-        std::cout << "Variable could not be fully resolved: " << variable.Dump()
-                  << " exception: " << e.what() << "\n";
-        return VariableState();
+        // Not assigning unchanged values keeps the memoized results valid
+        if(refined && *refined != current)
+            Assign(variable, *refined);
     }
 }
 
+VariableState ProgramState::GetVariableValue(const VariableIdentifier& variable) const
+{
+    // Stored values are always resolved so there is no copy chain to follow here
+    return GetVariableValueRaw(variable);
+}
+
 VariableState ProgramState::GetVariableValueRaw(const VariableIdentifier& variable) const
 {
-    const auto found = Variables.find(variable);
+    const auto found = Find(variable);
 
-    if(found == Variables.end()) {
+    if(!found) {
         return VariableState();
     }
-    return found->second;
+    return *found;
 }
 // ------------------------------------ //
-// DoneAnalysisRegistry
-bool DoneAnalysisRegistry::HasBeenDone(
-    const CodeBlock* func, const std::vector<VariableState>& params)
+bool ProgramState::operator==(const ProgramState& other) const
 {
-    const auto found = RecordedFunctionCalls.find(func->GetName());
-
-    if(found == RecordedFunctionCalls.end()) {
-        return false;
-    }
-
-    return found->second.find(params) != found->second.end();
+    return Frame == other.Frame && Slots == other.Slots && Globals == other.Globals;
 }
 
-void DoneAnalysisRegistry::Add(const CodeBlock* func, const std::vector<VariableState>& params)
+std::size_t ProgramState::Hash() const
+{
+    return CombineHash(CombineHash(MixHash(reinterpret_cast<uintptr_t>(Frame)), Slots.Hash()),
+        Globals.Hash());
+}
+// ------------------------------------ //
+void ProgramState::Rollback(size_t checkpoint)
 {
-    const auto existing = RecordedFunctionCalls.find(func->GetName());
+    while(Trail.size() > checkpoint) {
+        auto& entry = Trail.back();
 
-    if(existing == RecordedFunctionCalls.end()) {
-        RecordedFunctionCalls[func->GetName()] = {params};
-    } else {
-        existing->second.insert(params);
+        if(entry.Global) {
+            Globals = std::move(entry.Previous);
+        } else {
+            Slots = std::move(entry.Previous);
+        }
+
+        Versions = std::move(entry.PreviousVersions);
+
+        Trail.pop_back();
     }
 }
-
-bool DoneAnalysisRegistry::CheckAndAdd(
-    const CodeBlock* func, const std::vector<VariableState>& params)
+// ------------------------------------ //
+std::optional<bool> smacpp::FindAssumption(
+    const Assumptions& assumptions, const Condition& condition)
 {
-    if(HasBeenDone(func, params))
-        return false;
+    for(const auto& [assumed, value] : assumptions) {
+        if(assumed == condition)
+            return value;
 
-    Add(func, params);
-    return true;
-}
+        if(assumed.IsNegationOf(condition))
+            return !value;
+    }
 
+    return std::nullopt;
+}
 // ------------------------------------ //
 // AnalysisOperation
-void AnalysisOperation::HandleAction(const action::FunctionCall* call)
+AnalysisOperation::AnalysisOperation(const CodeBlock& function,
+    const BlockRegistry* availableFunctions, std::vector<FoundProblem>& reportProblems,
+    DoneAnalysisRegistry& doneOps) :
+    Actions(function.GetActions()), Groups(function.GetActionGroups()),
+    State(std::make_shared<ProgramState>(&function)), CurrentFunction(&function),
+    AvailableFunctions(availableFunctions), Problems(&reportProblems), DoneOperations(doneOps)
+{}
+// ------------------------------------ //
+void AnalysisOperation::PerformAction(size_t index)
+{
+    std::visit([&](const auto& data) { HandleAction(data, index); }, Actions[index].Action);
+}
+
+void AnalysisOperation::HandleAction(const action::FunctionCall& call, size_t)
+{
+    QueueCall(call, *State);
+}
+
+void AnalysisOperation::QueueCall(
+    const action::FunctionCall& call, const VariableValueProvider& values)
 {
-    const CodeBlock* calledFunction = AvailableFunctions->FindFunction(call->Function);
+    const auto& callInfo = CurrentFunction->GetCall(call.Call);
+    const CodeBlock* calledFunction = AvailableFunctions->FindFunction(callInfo.Function);
 
     if(calledFunction) {
 
@@ -126,59 +222,189 @@ void AnalysisOperation::HandleAction(const action::FunctionCall* call)
         //     return;
         // }
 
-        AnalysisOperation newOp(
-            calledFunction->GetActions(), AvailableFunctions, Problems, DoneOperations);
-        newOp.CurrentFunction = calledFunction;
+        // The parameters are resolved in the caller so that calls with the same values
+        // are only analysed once
+        std::vector<VariableState> params;
+        params.reserve(callInfo.Params.size());
 
-        if(Analyzer::ResolveCallParameters(newOp, *calledFunction, call->Params)) {
+        for(const auto& param : callInfo.Params)
+            params.push_back(param.Resolve(values));
 
-            // TODO: this should be moved to use the resolved parameters
-            if(DoneOperations.CheckAndAdd(calledFunction, call->Params)) {
-                FoundCalls.push_back(std::move(newOp));
-            }
+        if(Summary)
+            PathCalls.emplace_back(calledFunction, params);
+
+        QueueFunction(calledFunction, params);
+
+        if(Summaries)
+            ApplyCalleeGlobals(calledFunction, params);
+    }
+}
+
+void AnalysisOperation::ApplyCalleeGlobals(
+    const CodeBlock* function, const std::vector<VariableState>& params)
+{
+    auto summary = Summaries->Find(function, params);
+
+    // The summary for unknown parameters covers every call so it is used if the call with
+    // these parameters hasn't been analysed. Only published summaries are found so which
+    // one is used doesn't depend on the thread timing
+    if(!summary) {
+        const std::vector<VariableState> unknown(params.size());
+
+        if(unknown != params)
+            summary = Summaries->Find(function, unknown);
+    }
+
+    if(!summary)
+        return;
+
+    summary->Globals.ForEach([&](uint32_t global, const VariableState& value) {
+        State->Assign(VariableIdentifier(global), value);
+    });
+}
+
+void AnalysisOperation::QueueFunction(
+    const CodeBlock* function, const std::vector<VariableState>& params)
+{
+    const auto queued = DoneOperations.AddCall(function, params);
+
+    if(!queued)
+        return;
+
+    if(Summaries) {
+        if(const auto summary = Summaries->Find(function, *queued); summary) {
+            // Another analysis already went through this call, what it found is reported
+            // and its calls followed without running the function again
+            const auto& found = summary->Problems;
+            Problems->insert(Problems->end(), found.begin(), found.end());
+
+            for(const auto& [callee, calleeParams] : summary->Calls)
+                QueueFunction(callee, calleeParams);
+
+            return;
         }
     }
+
+    AnalysisOperation newOp(*function, AvailableFunctions, *Problems, DoneOperations);
+
+    if(!Analyzer::ResolveCallParameters(newOp, *function, *queued))
+        return;
+
+    if(Summaries) {
+        newOp.Summaries = Summaries;
+        newOp.Summary = std::make_shared<SummaryBuilder>(function, *queued);
+    }
+
+    FoundCalls.push_back(std::move(newOp));
 }
 
-void AnalysisOperation::HandleAction(const action::VarDeclared* var)
+void AnalysisOperation::HandleAction(const action::VarDeclared& var, size_t)
 {
-    // TODO: should resolve happen here?
-    State->CreateLocal(var->Variable, var->State.Resolve(*State));
+    State->CreateLocal(var.Variable, Memo.Resolve(var.State, *State));
 }
 
-void AnalysisOperation::HandleAction(const action::VarAssigned* var)
+void AnalysisOperation::HandleAction(const action::VarAssigned& var, size_t)
 {
-    // TODO: should resolve happen here?
-    State->Assign(var->Variable, var->State.Resolve(*State));
+    State->Assign(var.Variable, Memo.Resolve(var.State, *State));
 }
 
-void AnalysisOperation::HandleAction(const action::ArrayIndexAccess* index)
+void AnalysisOperation::HandleAction(const action::ArrayIndexAccess& access, size_t index)
+{
+    CheckArrayIndexAccess(access, index, *State);
+}
+
+void AnalysisOperation::Report(FoundProblem&& problem)
+{
+    if(Summary)
+        PathProblems.push_back(problem);
+
+    Problems->push_back(std::move(problem));
+}
+
+void AnalysisOperation::FinishSummary()
+{
+    if(!Summary)
+        return;
+
+    Summary->FinishPath(
+        std::move(PathProblems), std::move(PathCalls), State->Globals, *Summaries);
+    Summary.reset();
+}
+// ------------------------------------ //
+void AnalysisOperation::Assume(const Condition& condition, bool value)
 {
-    const auto array = State->GetVariableValue(index->Array).Resolve(*State);
+    Assumed.emplace_back(condition, value);
+    State->Assume(condition, value);
+}
+// ------------------------------------ //
+void AnalysisOperation::CheckArrayIndexAccess(const action::ArrayIndexAccess& access,
+    size_t index, const VariableValueProvider& values)
+{
+    const auto array = values.GetVariableValue(access.Array).Resolve(values);
 
     if(array.State == VariableState::STATE::Unknown)
         return;
 
-    const auto indexVar = index->Index.Resolve(*State);
+    const auto indexVar = access.Index.Resolve(values);
 
     if(indexVar.State == VariableState::STATE::Unknown)
         return;
 
-    if(auto buf = std::get_if<BufferInfo>(&array.Value); buf) {
+    if(array.State == VariableState::STATE::Buffer) {
+
+        const auto buf = array.GetBuffer();
 
         // TODO: emit line numbers
-        if(buf->NullPtr) {
-            Problems.push_back(FoundProblem(
-                FoundProblem::SEVERITY::Error, "Write to nullptr array", index->Location));
+        if(buf.NullPtr) {
+            Report(FoundProblem(FoundProblem::SEVERITY::Error, "Write to nullptr array",
+                CurrentFunction->GetActionLocation(index)));
         } else {
 
-            if(auto indexNumber = std::get_if<PrimitiveInfo>(&indexVar.Value); indexNumber) {
-                if(buf->AllocatedSize <= indexNumber->AsInteger()) {
+            if(indexVar.State == VariableState::STATE::Primitive) {
+                const auto indexNumber = indexVar.GetPrimitive();
 
-                    Problems.push_back(FoundProblem(FoundProblem::SEVERITY::Error,
-                        "Buffer overflow: buffer size: " + std::to_string(buf->AllocatedSize) +
-                            " used index: " + std::to_string(indexNumber->AsInteger()),
-                        index->Location));
+                if(indexNumber.AsInteger() < 0) {
+
+                    Report(FoundProblem(FoundProblem::SEVERITY::Error,
+                        "Buffer underflow: buffer size: " + std::to_string(buf.AllocatedSize) +
+                            " used index: " + std::to_string(indexNumber.AsInteger()),
+                        CurrentFunction->GetActionLocation(index)));
+
+                } else if(buf.AllocatedSize <= indexNumber.AsInteger()) {
+
+                    Report(FoundProblem(FoundProblem::SEVERITY::Error,
+                        "Buffer overflow: buffer size: " + std::to_string(buf.AllocatedSize) +
+                            " used index: " + std::to_string(indexNumber.AsInteger()),
+                        CurrentFunction->GetActionLocation(index)));
+                }
+            } else if(indexVar.State == VariableState::STATE::Range) {
+                const auto range = indexVar.GetInterval();
+                const auto size = buf.AllocatedSize;
+
+                // Only some of the values underflow unless even the highest one does
+                if(range.Low < 0) {
+                    const bool always = range.High < 0;
+
+                    Report(FoundProblem(always ? FoundProblem::SEVERITY::Error :
+                                                 FoundProblem::SEVERITY::Warning,
+                        std::string(
+                            always ? "Buffer underflow" : "Possible buffer underflow") +
+                            ": buffer size: " + std::to_string(size) +
+                            " used index: " + range.Dump(),
+                        CurrentFunction->GetActionLocation(index)));
+                }
+
+                // Only some of the values overflow unless even the lowest one does
+                if(range.High >= 0 && static_cast<uint64_t>(range.High) >= size) {
+                    const bool always =
+                        range.Low >= 0 && static_cast<uint64_t>(range.Low) >= size;
+
+                    Report(FoundProblem(always ? FoundProblem::SEVERITY::Error :
+                                                 FoundProblem::SEVERITY::Warning,
+                        std::string(always ? "Buffer overflow" : "Possible buffer overflow") +
+                            ": buffer size: " + std::to_string(size) +
+                            " used index: " + range.Dump(),
+                        CurrentFunction->GetActionLocation(index)));
                 }
             }
         }
@@ -195,8 +421,7 @@ bool Analyzer::BeginAnalysis(const CodeBlock& entryPoint,
 
     {
         AnalysisOperation entryAnalysis(
-            entryPoint.GetActions(), availableFunctions, Problems, AlreadyQueuedOps);
-        entryAnalysis.CurrentFunction = &entryPoint;
+            entryPoint, availableFunctions, Problems, AlreadyQueuedOps);
 
         if(!ResolveCallParameters(entryAnalysis, entryPoint, callParameters)) {
             Problems.push_back(FoundProblem(FoundProblem::SEVERITY::Error,
@@ -205,9 +430,31 @@ bool Analyzer::BeginAnalysis(const CodeBlock& entryPoint,
             return false;
         }
 
-        toCheck.push_back(std::move(entryAnalysis));
         // TODO: this should be moved to use the resolved parameters
         AlreadyQueuedOps.Add(&entryPoint, callParameters);
+
+        if(DepthFirst) {
+            Assumptions assumptions;
+
+            if(!ExploreDepthFirst(entryAnalysis, 0, assumptions)) {
+                Problems.push_back(FoundProblem(FoundProblem::SEVERITY::Error,
+                    "an analysis step failed", clang::SourceLocation{}));
+                return false;
+            }
+
+            return true;
+        }
+
+        if(Summaries) {
+            entryAnalysis.Summaries = Summaries;
+            entryAnalysis.Summary =
+                std::make_shared<SummaryBuilder>(&entryPoint, callParameters);
+        }
+
+        if(Jobs > 1)
+            return PerformParallelAnalysis(std::move(entryAnalysis));
+
+        toCheck.push_back(std::move(entryAnalysis));
     }
 
     while(!toCheck.empty()) {
@@ -234,6 +481,133 @@ bool Analyzer::BeginAnalysis(const CodeBlock& entryPoint,
     return true;
 }
 // ------------------------------------ //
+bool Analyzer::PerformParallelAnalysis(AnalysisOperation&& entry)
+{
+    std::vector<WorkerQueue<AnalysisOperation>> queues(Jobs);
+    std::vector<std::vector<FoundProblem>> workerProblems(Jobs);
+
+    // Queued operations and the ones being run, the workers stop once this reaches 0
+    std::atomic<size_t> pending(1);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    // Operations in the queues, idle workers sleep on workAvailable until this or pending
+    // changes. This is incremented before the push so it can't go below 0 when the
+    // operation is taken right after being pushed
+    std::atomic<size_t> queued(1);
+    std::mutex idleMutex;
+    std::condition_variable workAvailable;
+
+    // Notifying under the lock orders the change with the check done by a worker about to
+    // sleep, so the wakeup can't be lost
+    const auto wakeWorkers = [&]() {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        workAvailable.notify_all();
+    };
+
+    queues[0].PushBack(std::move(entry));
+
+    // Workers first take their own newest operation and then steal the oldest from others
+    const auto takeOperation = [&](size_t id) -> std::optional<AnalysisOperation> {
+        if(auto operation = queues[id].PopBack(); operation)
+            return operation;
+
+        for(size_t i = 1; i < Jobs; ++i) {
+            if(auto stolen = queues[(id + i) % Jobs].StealFront(); stolen)
+                return stolen;
+        }
+
+        return std::nullopt;
+    };
+
+    const auto worker = [&](size_t id) {
+        try {
+            while(!failed) {
+                auto operation = takeOperation(id);
+
+                if(!operation) {
+                    // Another worker is still running something that can queue more
+                    std::unique_lock<std::mutex> lock(idleMutex);
+                    workAvailable.wait(
+                        lock, [&]() { return failed || pending == 0 || queued > 0; });
+
+                    if(pending == 0)
+                        return;
+
+                    continue;
+                }
+
+                --queued;
+                operation->Problems = &workerProblems[id];
+
+                auto [success, newOps] = PerformAnalysisOperation(*operation);
+
+                if(!success) {
+                    failed = true;
+                    wakeWorkers();
+                    return;
+                }
+
+                // New operations are counted before the finished one is removed so that
+                // pending can't reach 0 while there is work left
+                pending += newOps.size();
+
+                for(auto& op : newOps) {
+                    ++queued;
+                    queues[id].PushBack(std::move(op));
+                }
+
+                if(--pending == 0 || !newOps.empty())
+                    wakeWorkers();
+            }
+        } catch(...) {
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+
+                if(!error)
+                    error = std::current_exception();
+            }
+
+            failed = true;
+            wakeWorkers();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for(size_t i = 1; i < Jobs; ++i)
+        threads.emplace_back(worker, i);
+
+    worker(0);
+
+    for(auto& thread : threads)
+        thread.join();
+
+    if(error)
+        std::rethrow_exception(error);
+
+    std::vector<FoundProblem> found;
+
+    for(auto& problems : workerProblems)
+        found.insert(found.end(), problems.begin(), problems.end());
+
+    // Each fork budget belongs to a single function call and is split between its paths, so
+    // the same operations are run regardless of the order and sorting gives the same report
+    // on every run
+    std::sort(found.begin(), found.end());
+
+    Problems.insert(Problems.end(), found.begin(), found.end());
+
+    if(failed) {
+        Problems.push_back(FoundProblem(FoundProblem::SEVERITY::Error,
+            "an analysis step failed", clang::SourceLocation{}));
+        return false;
+    }
+
+    return true;
+}
+// ------------------------------------ //
 bool Analyzer::ResolveCallParameters(AnalysisOperation& operation, const CodeBlock& function,
     const std::vector<VariableState>& callParameters)
 {
@@ -254,30 +628,266 @@ bool Analyzer::ResolveCallParameters(AnalysisOperation& operation, const CodeBlo
 std::tuple<bool, std::list<AnalysisOperation>> Analyzer::PerformAnalysisOperation(
     AnalysisOperation& operation)
 {
-    // TODO: when a conditional is uncertain the check needs to be split into two here to
-    // independently check both uncertain outcomes
+    const CodeBlock& function = *operation.CurrentFunction;
 
-    for(auto iter = operation.Actions.begin(); iter != operation.Actions.end(); ++iter) {
+    if(const auto ssa = function.GetSSA(); ssa)
+        return PerformSSAOperation(operation, *ssa);
 
-        const ProcessedAction& action = **iter;
+    std::list<AnalysisOperation> forks;
 
-        try {
-            if(operation.State->MatchesCondition(action.If)) {
+    for(size_t i = operation.StartGroup; i < operation.Groups.size(); ++i) {
 
+        const ActionGroup& group = operation.Groups[i];
+
+        // The guard is evaluated once for the whole group, and the memo reuses the result
+        // until an action writes a variable the guard reads
+        const auto result = operation.Memo.MatchesCondition(group.If, *operation.State);
+
+        // Conditions that were already forked on keep the same value on this path unless
+        // the state now decides them, as after a write to a variable they read
+        auto matches = result != TRI_STATE::Unknown ?
+                           std::optional<bool>(result == TRI_STATE::True) :
+                           FindAssumption(operation.Assumed, group.If);
+
+        if(!matches) {
+            if(!ReserveFork(operation, operation.Assumed.size())) {
                 if(Debug)
-                    std::cout << "analysis at step: " << action.Dump() << "\n";
-                action.Dispatch(operation);
+                    std::cout << "Unknown variable state in condition: " << group.If.Dump()
+                              << "\n";
 
+                // Out of forks, the group is skipped
+                matches = false;
             } else {
-                // If the failure was due to unknown variable states execution should split
-                // here, see the TODO above
+                if(Debug)
+                    std::cout << "forking on unknown condition: " << group.If.Dump() << "\n";
+
+                // The fork is queued to run the path where the condition is false and this
+                // operation continues on the path where it is true
+                forks.push_back(ForkOperation(operation, i));
+                operation.Assume(group.If, true);
+                matches = true;
+            }
+        }
+
+        if(!*matches)
+            continue;
+
+        for(size_t action = group.Begin; action < group.End; ++action) {
+            if(Debug) {
+                std::cout << "analysis at step: "
+                          << operation.CurrentFunction->DumpAction(action) << "\n";
             }
-        } catch(const UnknownVariableStateException& e) {
-            if(Debug)
-                std::cout << "Unknown variable state at step: " << action.Dump() << ": "
-                          << action.Dump() << "\n";
+
+            operation.PerformAction(action);
         }
     }
 
+    operation.FinishSummary();
+
+    auto newOps = operation.FoundCalls;
+    newOps.splice(newOps.end(), forks);
+
+    return std::make_tuple(true, std::move(newOps));
+}
+
+bool Analyzer::ReserveFork(AnalysisOperation& operation, size_t forkDepth)
+{
+    if(forkDepth >= ForkDepthLimit)
+        return false;
+
+    if(!operation.ForkBudget)
+        operation.ForkBudget = PathBudget;
+
+    if(*operation.ForkBudget == 0)
+        return false;
+
+    --*operation.ForkBudget;
+    return true;
+}
+
+AnalysisOperation Analyzer::ForkOperation(AnalysisOperation& operation, size_t index)
+{
+    // The paths only use their own share of the budget, so the forks made by each path are
+    // the same whichever of them runs first
+    const auto forkBudget = *operation.ForkBudget / 2;
+    *operation.ForkBudget -= forkBudget;
+
+    AnalysisOperation fork(operation);
+    fork.ForkBudget = forkBudget;
+
+    // The persistent maps make copying the state O(1)
+    fork.State = std::make_shared<ProgramState>(*operation.State);
+
+    // Calls and problems found before the fork belong to the original path
+    fork.FoundCalls.clear();
+    fork.PathProblems.clear();
+    fork.PathCalls.clear();
+
+    if(fork.Summary)
+        fork.Summary->AddPath();
+
+    fork.StartGroup = index + 1;
+    fork.Assume(operation.Groups[index].If, false);
+    return fork;
+}
+
+std::tuple<bool, std::list<AnalysisOperation>> Analyzer::PerformSSAOperation(
+    AnalysisOperation& operation, const SSAForm& ssa)
+{
+    const CodeBlock& function = *operation.CurrentFunction;
+
+    std::vector<VariableState> values(ssa.GetValueCount());
+
+    // Only the actions and guards that can affect a sink are evaluated, the values of the
+    // skipped actions are never read by the evaluated ones
+    for(const auto entry : ssa.GetEntryValues()) {
+        if(ssa.IsValueLive(entry))
+            values[entry] = operation.State->GetVariableValue(ssa.GetValue(entry).Variable);
+    }
+
+    for(size_t group = 0; group < operation.Groups.size(); ++group) {
+
+        if(!ssa.IsGroupLive(group))
+            continue;
+
+        const ActionGroup& actionGroup = operation.Groups[group];
+
+        const SSAValueProvider guardValues(
+            function.GetGuardReads(actionGroup.Guard), ssa.GetGroupReads(group), values);
+        const auto matches = actionGroup.If.Evaluate(guardValues);
+
+        if(matches == TRI_STATE::Unknown && Debug)
+            std::cout << "Unknown variable state in condition: " << actionGroup.If.Dump()
+                      << "\n";
+
+        const bool taken = matches == TRI_STATE::True;
+
+        for(size_t i = actionGroup.Begin; taken && i < actionGroup.End; ++i) {
+
+            if(!ssa.IsActionLive(i))
+                continue;
+
+            if(Debug) {
+                std::cout << "analysis at step: " << function.DumpAction(i) << "\n";
+            }
+
+            const SSAValueProvider actionValues(
+                function.GetActionReads(i), ssa.GetActionReads(i), values);
+            const auto definitions = ssa.GetActionDefinitions(i);
+            const auto& action = operation.Actions[i].Action;
+
+            if(const auto declared = std::get_if<action::VarDeclared>(&action)) {
+                values[*definitions.begin()] = declared->State.Resolve(actionValues);
+            } else if(const auto assigned = std::get_if<action::VarAssigned>(&action)) {
+                values[*definitions.begin()] = assigned->State.Resolve(actionValues);
+            } else if(const auto access = std::get_if<action::ArrayIndexAccess>(&action)) {
+                operation.CheckArrayIndexAccess(*access, i, actionValues);
+            } else if(const auto call = std::get_if<action::FunctionCall>(&action)) {
+                operation.QueueCall(*call, actionValues);
+            } else {
+                operation.PerformAction(i);
+            }
+        }
+
+        for(const auto phi : ssa.GetGroupPhis(group)) {
+            const auto& value = ssa.GetValue(phi);
+            values[phi] = values[taken ? value.Incoming : value.Previous];
+        }
+    }
+
+    // The writes are only in the SSA values, and the dead ones aren't even computed, so the
+    // summaries made here don't have the effects on globals
+    operation.FinishSummary();
+
     return std::make_tuple(true, operation.FoundCalls);
 }
+// ------------------------------------ //
+bool Analyzer::ExploreDepthFirst(
+    AnalysisOperation& operation, size_t start, Assumptions& assumptions)
+{
+    for(size_t i = start; i < operation.Groups.size(); ++i) {
+
+        const ActionGroup& group = operation.Groups[i];
+
+        const auto result = operation.Memo.MatchesCondition(group.If, *operation.State);
+
+        // Like in the queue based analysis the assumptions are only used when the state
+        // doesn't decide the condition
+        auto matches = result != TRI_STATE::Unknown ?
+                           std::optional<bool>(result == TRI_STATE::True) :
+                           FindAssumption(assumptions, group.If);
+
+        if(!matches) {
+            // Like in the queue based analysis the depth only counts the forks of this
+            // function call, the callees start from 0 with their own assumptions
+            if(!ReserveFork(operation, assumptions.size())) {
+                // Out of forks, skip the action like the queue based analysis does
+                matches = false;
+            } else {
+                if(Debug)
+                    std::cout << "forking on unknown condition: " << group.If.Dump() << "\n";
+
+                // Explore the path where the condition is true and then undo it to continue
+                // the path where it is false
+                // The budget is split between the paths like in the queue based analysis
+                const auto budget = *operation.ForkBudget;
+                operation.ForkBudget = budget - budget / 2;
+
+                const auto checkpoint = operation.State->Checkpoint();
+                assumptions.emplace_back(group.If, true);
+                operation.State->Assume(group.If, true);
+
+                bool success = PerformDepthFirstGroup(operation, group) &&
+                               ExploreDepthFirst(operation, i + 1, assumptions);
+
+                operation.State->Rollback(checkpoint);
+                operation.ForkBudget = budget / 2;
+                std::get<1>(assumptions.back()) = false;
+                operation.State->Assume(group.If, false);
+
+                success = success && ExploreDepthFirst(operation, i + 1, assumptions);
+
+                assumptions.pop_back();
+                return success;
+            }
+        }
+
+        if(*matches && !PerformDepthFirstGroup(operation, group))
+            return false;
+    }
+
+    return true;
+}
+
+bool Analyzer::PerformDepthFirstGroup(AnalysisOperation& operation, const ActionGroup& group)
+{
+    for(size_t i = group.Begin; i < group.End; ++i) {
+        if(!PerformDepthFirstAction(operation, i))
+            return false;
+    }
+
+    return true;
+}
+
+bool Analyzer::PerformDepthFirstAction(AnalysisOperation& operation, size_t index)
+{
+    if(Debug) {
+        std::cout << "analysis at step: " << operation.CurrentFunction->DumpAction(index)
+                  << "\n";
+    }
+
+    operation.PerformAction(index);
+
+    // Called functions are analysed right away with their own states instead of queueing
+    auto calls = std::move(operation.FoundCalls);
+    operation.FoundCalls.clear();
+
+    for(auto& call : calls) {
+        Assumptions calleeAssumptions;
+
+        if(!ExploreDepthFirst(call, 0, calleeAssumptions))
+            return false;
+    }
+
+    return true;
+}
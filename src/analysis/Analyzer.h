@@ -1,19 +1,26 @@
 #pragma once
 
+#include "DoneAnalysisRegistry.h"
+#include "EvaluationMemo.h"
+#include "PersistentIntMap.h"
+
 #include "parse/ProcessedAction.h"
 
 #include <clang/Basic/SourceLocation.h>
 
 #include <list>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <tuple>
 #include <vector>
 
 namespace smacpp {
 
 class CodeBlock;
 class BlockRegistry;
+class SSAForm;
+class SummaryBuilder;
+class SummaryCache;
 
 struct FoundProblem {
     enum class SEVERITY { Info, Warning, Error };
@@ -23,72 +30,219 @@ struct FoundProblem {
 
     std::string FormatAsString() const;
 
+    //! \brief Orders by location, message and severity so that sorted reports don't depend
+    //! on the order the problems were found in
+    bool operator<(const FoundProblem& other) const;
+
+    bool operator==(const FoundProblem& other) const
+    {
+        return Location.getRawEncoding() == other.Location.getRawEncoding() &&
+               Message == other.Message && Severity == other.Severity;
+    }
+
     clang::SourceLocation Location;
     std::string Message;
     SEVERITY Severity;
 };
 
 //! Program state in analysis
+//!
+//! Parameters and locals of the analysed function are stored by their frame slot, everything
+//! else (mostly globals) by SymbolID. Both maps are persistent so copying a state to fork the
+//! analysis is O(1) and the copies share everything that isn't changed afterwards. Only
+//! resolved values are stored so reading a variable is a single lookup
 class ProgramState : public VariableValueProvider {
 public:
+    //! \param frame The function this is the state of, its frame slots are used for storage
+    ProgramState(const CodeBlock* frame = nullptr);
+
     void CreateLocal(VariableIdentifier identifier, VariableState initialState);
     void Assign(VariableIdentifier identifier, VariableState state);
 
-    //! \returns True if current state matches Condition. Unknown variables are assumed to
-    //! have the wrong value
-    bool MatchesCondition(const Condition& condition) const;
+    //! \returns True if current state matches Condition, Unknown if that depends on
+    //! variables whose values aren't known
+    TRI_STATE MatchesCondition(const Condition& condition) const;
+
+    //! \brief Constrains the state with the values condition having value implies
+    //!
+    //! Used when the analysis forks on an unknown condition. The variables the condition
+    //! compares are narrowed, for example assuming "x == 5" true sets x to 5 and assuming
+    //! "x < 5" true sets an unknown x to an interval ending at 4
+    void Assume(const Condition& condition, bool value);
 
     VariableState GetVariableValue(const VariableIdentifier& variable) const override;
     VariableState GetVariableValueRaw(const VariableIdentifier& variable) const override;
 
-    std::unordered_map<VariableIdentifier, VariableState> Variables;
-};
+    //! \brief Compares all variable values, subtrees shared between the states are skipped
+    bool operator==(const ProgramState& other) const;
+
+    bool operator!=(const ProgramState& other) const
+    {
+        return !(*this == other);
+    }
+
+    //! \brief O(1) hash of the whole state, uses the cached hashes of the maps
+    std::size_t Hash() const;
+
+    //! \brief Starts recording changes to the undo trail
+    //! \returns Position to pass to Rollback to undo all changes made after this call
+    size_t Checkpoint()
+    {
+        RecordTrail = true;
+        return Trail.size();
+    }
+
+    //! \brief Undoes all changes made since checkpoint was created
+    //! \note The version counter isn't rolled back so versions are never reused
+    void Rollback(size_t checkpoint);
+
+    //! \returns The version counter, this is incremented by each write
+    uint32_t GetVersion() const
+    {
+        return Version;
+    }
+
+    //! \returns The version of the write that set the current value of variable, 0 if it
+    //! hasn't been written
+    //!
+    //! As each write gets a unique version a variable has the same value whenever it has the
+    //! same version, this is used by EvaluationMemo to detect that a cached result is valid
+    uint32_t GetVariableVersion(const VariableIdentifier& variable) const
+    {
+        const auto found = Versions.Find(variable.ID);
+        return found ? *found : 0;
+    }
+
+private:
+    //! \returns The storage for a variable or null if it hasn't been set
+    const VariableState* Find(const VariableIdentifier& variable) const;
+
+    //! \brief Sets the value of a variable, state is resolved first if it refers to other
+    //! variables
+    void Store(const VariableIdentifier& variable, VariableState state);
+
+    //! \returns True if variable has a slot in Frame
+    bool IsFrameVariable(const VariableIdentifier& variable) const;
+
+    //! \brief A change recorded for Rollback. As the maps are persistent the previous map
+    //! versions are stored, which is O(1) and doesn't need the maps to support erasing
+    struct TrailEntry {
+        bool Global;
+        PersistentIntMap<VariableState> Previous;
+        PersistentIntMap<uint32_t> PreviousVersions;
+    };
 
-//! Makes sure each codeblock is not analysed multiple times
-class DoneAnalysisRegistry {
 public:
-    bool HasBeenDone(const CodeBlock* func, const std::vector<VariableState>& params);
-    void Add(const CodeBlock* func, const std::vector<VariableState>& params);
+    const CodeBlock* Frame;
 
-    //! \brief Adds a call to the registry if it wasn't already added
-    //! \returns True if the func call was not in the registry and was added
-    bool CheckAndAdd(const CodeBlock* func, const std::vector<VariableState>& params);
+    //! Indexed by the frame slots of Frame
+    PersistentIntMap<VariableState> Slots;
 
-protected:
-    std::unordered_map<std::string, std::unordered_set<std::vector<VariableState>>>
-        RecordedFunctionCalls;
+    //! Variables that don't have a slot in Frame, indexed by SymbolID
+    PersistentIntMap<VariableState> Globals;
+
+private:
+    //! Version of the last write of each variable, indexed by SymbolID. These are not part of
+    //! the state when comparing
+    PersistentIntMap<uint32_t> Versions;
+    uint32_t Version = 0;
+
+    std::vector<TrailEntry> Trail;
+    bool RecordTrail = false;
 };
 
+//! A function and the parameters it was called with
+using CalledFunction = std::tuple<const CodeBlock*, std::vector<VariableState>>;
+
+//! Values assumed for unknown conditions on the current path of a function
+using Assumptions = std::vector<std::tuple<Condition, bool>>;
+
+//! \returns The value assumed for condition or its negation, if any
+std::optional<bool> FindAssumption(const Assumptions& assumptions, const Condition& condition);
+
 //! A single operation the analysis is split into
 class AnalysisOperation {
 public:
-    AnalysisOperation(const std::vector<std::unique_ptr<ProcessedAction>>& actions,
-        const BlockRegistry* availableFunctions, std::vector<FoundProblem>& reportProblems,
-        DoneAnalysisRegistry& doneOps) :
-        Actions(actions),
-        State(std::make_shared<ProgramState>()), AvailableFunctions(availableFunctions),
-        Problems(reportProblems), DoneOperations(doneOps)
-    {}
-
-    // Double dispatch
-    void HandleAction(const action::FunctionCall* call);
-    void HandleAction(const action::VarDeclared* var);
-    void HandleAction(const action::VarAssigned* var);
-    void HandleAction(const action::ArrayIndexAccess* index);
-
-    //! Base action with no action
-    void HandleAction(const ProcessedAction* action) {}
+    AnalysisOperation(const CodeBlock& function, const BlockRegistry* availableFunctions,
+        std::vector<FoundProblem>& reportProblems, DoneAnalysisRegistry& doneOps);
+
+    //! \brief Runs the action at index in Actions, its condition is not checked
+    void PerformAction(size_t index);
+
+    void HandleAction(const action::FunctionCall& call, size_t index);
+    void HandleAction(const action::VarDeclared& var, size_t index);
+    void HandleAction(const action::VarAssigned& var, size_t index);
+    void HandleAction(const action::ArrayIndexAccess& access, size_t index);
+
+    //! \brief Checks an array access with the variable values from values
+    void CheckArrayIndexAccess(const action::ArrayIndexAccess& access, size_t index,
+        const VariableValueProvider& values);
+
+    //! \brief Queues the analysis of a called function with the parameters resolved from
+    //! values, unless the registry already has an analysis covering the call
+    void QueueCall(const action::FunctionCall& call, const VariableValueProvider& values);
+
+    //! \brief Queues the analysis of function, if it has a summary that is used instead
+    void QueueFunction(const CodeBlock* function, const std::vector<VariableState>& params);
+
+    //! \brief Writes the globals the called function leaves behind to State
+    //!
+    //! This needs a finished summary of the function so it only does something in the
+    //! bottom up analysis, where the callees are analysed before their callers
+    void ApplyCalleeGlobals(
+        const CodeBlock* function, const std::vector<VariableState>& params);
+
+    //! \brief Adds a problem found in the current function
+    void Report(FoundProblem&& problem);
+
+    //! \brief Adds what this path found to the summary of its function call
+    void FinishSummary();
+
+    //! \brief Makes this path assume a value for an unknown condition
+    //!
+    //! The assumption is recorded so that the same condition and its negation keep that
+    //! value on this path, and State is constrained with it
+    void Assume(const Condition& condition, bool value);
 
 public:
-    const std::vector<std::unique_ptr<ProcessedAction>>& Actions;
+    const std::vector<ProcessedAction>& Actions;
+    const std::vector<ActionGroup>& Groups;
     std::shared_ptr<ProgramState> State;
 
+    //! Cached evaluations against State, only valid for State and its rollbacks
+    EvaluationMemo Memo;
+
+    //! Group the queue based analysis starts from, forks continue after the group they
+    //! forked on
+    size_t StartGroup = 0;
+
+    //! Unknown conditions this path has forked on and the values taken for them
+    Assumptions Assumed;
+
+    //! Forks this path and the paths forked from it can still make. Unset until the first
+    //! unknown condition of the function call, which then gets the whole path budget
+    std::optional<size_t> ForkBudget;
+
+    //! Finished function summaries, null if summaries aren't used
+    SummaryCache* Summaries = nullptr;
+
+    //! Builds the summary of the function call this operation analyses, shared with the
+    //! paths forked from it
+    std::shared_ptr<SummaryBuilder> Summary;
+
+    //! What this path has found, added to Summary once the path ends
+    std::vector<FoundProblem> PathProblems;
+    std::vector<CalledFunction> PathCalls;
+
     std::list<AnalysisOperation> FoundCalls;
 
     //! Used for recursion detection
     const CodeBlock* CurrentFunction = nullptr;
     const BlockRegistry* AvailableFunctions = nullptr;
-    std::vector<FoundProblem>& Problems;
+
+    //! Found problems are added here, the parallel analysis points this to a vector of the
+    //! worker running the operation
+    std::vector<FoundProblem>* Problems;
     DoneAnalysisRegistry& DoneOperations;
 };
 
@@ -110,6 +264,62 @@ public:
         Debug = debug;
     }
 
+    //! \brief Switches to exploring paths depth first
+    //!
+    //! Called functions are analysed immediately when the call is reached and conditions that
+    //! can't be evaluated are explored both ways. Changes to the state are undone with the
+    //! ProgramState undo trail when backtracking so the memory use stays proportional to the
+    //! path depth instead of the number of queued operations
+    void SetDepthFirst(bool depthFirst)
+    {
+        DepthFirst = depthFirst;
+    }
+
+    //! \brief Sets how many threads the queue based analysis uses
+    //!
+    //! With more than one the queued operations are run by workers that steal operations
+    //! from each other when they run out. The found problems are sorted by location once all
+    //! workers are done so that the report doesn't depend on the thread timing. Which calls
+    //! are widened does depend on it so the context limit should be disabled
+    void SetJobs(size_t jobs)
+    {
+        Jobs = jobs;
+    }
+
+    //! \brief Sets how many distinct parameter tuples a function is analysed with before the
+    //! further calls are widened, 0 disables widening. See DoneAnalysisRegistry
+    void SetContextLimit(size_t limit)
+    {
+        AlreadyQueuedOps.SetContextLimit(limit);
+    }
+
+    //! \brief Makes the queue based analysis record function summaries into cache and use
+    //! the summaries found there instead of analysing the same calls again
+    //!
+    //! The globals written by a called function that has a summary are also applied to the
+    //! caller after the call
+    void SetSummaryCache(SummaryCache* cache)
+    {
+        Summaries = cache;
+    }
+
+    //! \brief Sets how many unknown conditions a single path of a function call can fork on,
+    //! the paths of the called functions start from 0
+    void SetForkDepthLimit(size_t limit)
+    {
+        ForkDepthLimit = limit;
+    }
+
+    //! \brief Sets how many forks on unknown conditions the analysis of a single function
+    //! call can make in total, once these run out unknown conditions are treated as false
+    //!
+    //! Each fork splits the remaining budget between its two paths so the forks a path can
+    //! make don't depend on the order the paths are run in
+    void SetPathBudget(size_t budget)
+    {
+        PathBudget = budget;
+    }
+
     static bool ResolveCallParameters(AnalysisOperation& operation, const CodeBlock& function,
         const std::vector<VariableState>& callParameters);
 
@@ -117,10 +327,61 @@ private:
     std::tuple<bool, std::list<AnalysisOperation>> PerformAnalysisOperation(
         AnalysisOperation& operation);
 
+    //! \brief Runs entry and all the operations it queues on Jobs worker threads
+    bool PerformParallelAnalysis(AnalysisOperation&& entry);
+
+    //! \brief Runs an operation on the SSA form of its function
+    //!
+    //! The values are stored in a flat vector indexed by SSA value, the state of the
+    //! operation is only read for the values at function entry. Actions that can't affect a
+    //! sink are skipped
+    std::tuple<bool, std::list<AnalysisOperation>> PerformSSAOperation(
+        AnalysisOperation& operation, const SSAForm& ssa);
+
+    //! \returns True if a path can fork on the unknown condition it is at, the fork is
+    //! taken from the budget of operation
+    bool ReserveFork(AnalysisOperation& operation, size_t forkDepth);
+
+    //! \brief Creates the operation that continues after the group at index assuming its
+    //! condition is false
+    //!
+    //! The remaining fork budget of operation is split between it and the new operation
+    static AnalysisOperation ForkOperation(AnalysisOperation& operation, size_t index);
+
+    //! \brief Runs the action groups of operation starting from the group at start to the
+    //! end of the function
+    bool ExploreDepthFirst(
+        AnalysisOperation& operation, size_t start, Assumptions& assumptions);
+
+    //! \brief Runs the actions of a group whose guard is known to be true
+    bool PerformDepthFirstGroup(AnalysisOperation& operation, const ActionGroup& group);
+
+    //! \brief Runs a single action and descends into the functions it calls
+    bool PerformDepthFirstAction(AnalysisOperation& operation, size_t index);
+
 private:
     std::vector<FoundProblem>& Problems;
     DoneAnalysisRegistry AlreadyQueuedOps;
     bool Debug = false;
+
+    size_t Jobs = 1;
+    SummaryCache* Summaries = nullptr;
+
+    bool DepthFirst = false;
+    size_t ForkDepthLimit = 16;
+    size_t PathBudget = 1024;
 };
 
 } // namespace smacpp
+
+namespace std {
+
+template<>
+struct hash<smacpp::ProgramState> {
+    std::size_t operator()(const smacpp::ProgramState& k) const
+    {
+        return k.Hash();
+    }
+};
+
+} // namespace std
@@ -1,8 +1,48 @@
 // ------------------------------------ //
 #include "BlockRegistry.h"
 
+#include "CallGraph.h"
+#include "FunctionSummary.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 using namespace smacpp;
 // ------------------------------------ //
+namespace {
+
+void ConfigureAnalyzer(
+    Analyzer& analyzer, const AnalysisOptions& options, SummaryCache* summaries)
+{
+    analyzer.SetDebug(options.Debug);
+    analyzer.SetDepthFirst(options.DepthFirst);
+    analyzer.SetJobs(options.Jobs);
+    analyzer.SetForkDepthLimit(options.ForkDepthLimit);
+    analyzer.SetPathBudget(options.PathBudget);
+    analyzer.SetContextLimit(options.ContextLimit);
+    analyzer.SetSummaryCache(summaries);
+}
+
+std::vector<VariableState> MakeMainParameters(const CodeBlock& main)
+{
+    std::vector<VariableState> params;
+
+    if(main.GetParameters().size() == 2 || main.GetParameters().size() == 3) {
+
+        // TODO: these could be more intelligently done
+        while(main.GetParameters().size() != params.size()) {
+            params.push_back(VariableState{});
+        }
+    }
+
+    return params;
+}
+
+} // namespace
+// ------------------------------------ //
 void BlockRegistry::AddBlock(CodeBlock&& block)
 {
     if(FunctionBlocks.find(block.GetName()) != FunctionBlocks.end()) {
@@ -12,30 +52,31 @@ void BlockRegistry::AddBlock(CodeBlock&& block)
 
     FunctionBlocks.insert_or_assign(block.GetName(), std::move(block));
 }
+
+void BlockRegistry::BuildSSA()
+{
+    for(auto& [name, block] : FunctionBlocks)
+        block.BuildSSA();
+}
 // ------------------------------------ //
-std::vector<FoundProblem> BlockRegistry::PerformAnalysis(bool debug) const
+std::vector<FoundProblem> BlockRegistry::PerformAnalysis(const AnalysisOptions& options) const
 {
+    if(options.BottomUp)
+        return PerformBottomUpAnalysis(options);
+
     std::vector<FoundProblem> problems;
 
     const auto mainIter = FunctionBlocks.find("main");
 
     if(mainIter != FunctionBlocks.end()) {
 
+        // The registry of the analyzer already makes sure each call is analysed once, so
+        // summaries would never be reused here
         Analyzer analyzer(problems);
-        analyzer.SetDebug(debug);
-
-        std::vector<VariableState> params;
-
-        if(mainIter->second.GetParameters().size() == 2 ||
-            mainIter->second.GetParameters().size() == 3) {
-
-            // TODO: these could be more intelligently done
-            while(mainIter->second.GetParameters().size() != params.size()) {
-                params.push_back(VariableState{});
-            }
-        }
+        ConfigureAnalyzer(analyzer, options, nullptr);
 
-        if(!analyzer.BeginAnalysis(mainIter->second, this, params)) {
+        if(!analyzer.BeginAnalysis(
+               mainIter->second, this, MakeMainParameters(mainIter->second))) {
 
             problems.push_back(FoundProblem(FoundProblem::SEVERITY::Error,
                 "Analysis encountered a fatal error", mainIter->second.GetLocation()));
@@ -50,6 +91,101 @@ std::vector<FoundProblem> BlockRegistry::PerformAnalysis(bool debug) const
 
     return problems;
 }
+
+std::vector<FoundProblem> BlockRegistry::PerformBottomUpAnalysis(
+    const AnalysisOptions& options) const
+{
+    const CallGraph graph(*this);
+    const auto& functions = graph.GetFunctions();
+
+    const auto main = std::find_if(functions.begin(), functions.end(),
+        [](const CodeBlock* function) { return function->GetName() == "main"; });
+
+    if(main == functions.end()) {
+        return {FoundProblem(FoundProblem::SEVERITY::Error, "'main' function was not found",
+            clang::SourceLocation{})};
+    }
+
+    const auto mainIndex = static_cast<uint32_t>(std::distance(functions.begin(), main));
+
+    // The functions main can't reach can't affect the report
+    const auto reachable = graph.FindReachable(mainIndex);
+
+    SummaryCache summaries;
+
+    // The unknown parameters make these cover paths main may never take, so only the
+    // summaries are kept and the problems are reported by the analysis from main
+    const auto summariseFunction = [&](uint32_t index) {
+        const CodeBlock& function = *functions[index];
+
+        std::vector<FoundProblem> ignored;
+        Analyzer analyzer(ignored);
+        ConfigureAnalyzer(analyzer, options, &summaries);
+
+        // The parallelism is over the components so each analysis runs on one thread
+        analyzer.SetJobs(1);
+
+        const std::vector<VariableState> params(function.GetParameters().size());
+        analyzer.BeginAnalysis(function, this, params);
+    };
+
+    for(const auto& level : graph.GetLevels()) {
+
+        // Components of the same level don't call each other so they can be analysed in
+        // any order
+        std::atomic<size_t> next(0);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        const auto worker = [&]() {
+            try {
+                for(size_t i = next++; i < level.size(); i = next++) {
+                    for(const auto member : graph.GetMembers(level[i])) {
+                        if(reachable[member] && member != mainIndex)
+                            summariseFunction(member);
+                    }
+                }
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+
+                if(!error)
+                    error = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+
+        for(size_t i = 1; i < std::min(options.Jobs, level.size()); ++i)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for(auto& thread : threads)
+            thread.join();
+
+        if(error)
+            std::rethrow_exception(error);
+
+        // The next level sees everything this level found
+        summaries.Publish();
+    }
+
+    std::vector<FoundProblem> problems;
+
+    Analyzer analyzer(problems);
+    ConfigureAnalyzer(analyzer, options, &summaries);
+
+    if(!analyzer.BeginAnalysis(**main, this, MakeMainParameters(**main))) {
+        problems.push_back(FoundProblem(FoundProblem::SEVERITY::Error,
+            "Analysis encountered a fatal error", (*main)->GetLocation()));
+    }
+
+    // A problem in a callee is reported by each call that uses its summary
+    std::sort(problems.begin(), problems.end());
+    problems.erase(std::unique(problems.begin(), problems.end()), problems.end());
+
+    return problems;
+}
 // ------------------------------------ //
 const CodeBlock* BlockRegistry::FindFunction(const std::string& name) const
 {
@@ -60,3 +196,18 @@ const CodeBlock* BlockRegistry::FindFunction(const std::string& name) const
 
     return &found->second;
 }
+
+std::vector<const CodeBlock*> BlockRegistry::GetFunctions() const
+{
+    std::vector<const CodeBlock*> functions;
+
+    for(const auto& [name, block] : FunctionBlocks)
+        functions.push_back(&block);
+
+    std::sort(functions.begin(), functions.end(),
+        [](const CodeBlock* lhs, const CodeBlock* rhs) {
+            return lhs->GetName() < rhs->GetName();
+        });
+
+    return functions;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AnalysisOptions.h"
 #include "Analyzer.h"
 #include "parse/CodeBlock.h"
 
@@ -16,11 +17,29 @@ public:
 
     const CodeBlock* FindFunction(const std::string& name) const;
 
+    //! \returns All the functions sorted by name
+    std::vector<const CodeBlock*> GetFunctions() const;
+
+    //! \brief Lowers all blocks to SSA form
+    void BuildSSA();
+
     //! \brief Performs the static analysis starting from "main" and other good candidate
     //! functions
-    std::vector<FoundProblem> PerformAnalysis(bool debug) const;
+    std::vector<FoundProblem> PerformAnalysis(const AnalysisOptions& options) const;
 
 private:
+    //! \brief Summarises every function main can reach with unknown parameters, callees
+    //! before callers, and then analyses main with the summaries
+    //!
+    //! The components of the call graph are summarised level by level, the components of a
+    //! level in parallel on options.Jobs threads. These runs only fill the summary cache,
+    //! the problems are reported by the analysis from main so that paths main never takes
+    //! aren't reported. The summaries are looked up by the exact parameters, so a call is
+    //! only not analysed again if it passes on unknown values or a lower level already made
+    //! the same call. Other calls analyse the callee like the top down analysis does, and
+    //! get the globals of the callee from its summary for unknown parameters
+    std::vector<FoundProblem> PerformBottomUpAnalysis(const AnalysisOptions& options) const;
+
     std::unordered_map<std::string, CodeBlock> FunctionBlocks;
 };
 
@@ -0,0 +1,156 @@
+// ------------------------------------ //
+#include "CallGraph.h"
+
+#include "BlockRegistry.h"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+
+using namespace smacpp;
+// ------------------------------------ //
+CallGraph::CallGraph(const BlockRegistry& registry) : Functions(registry.GetFunctions())
+{
+    std::unordered_map<const CodeBlock*, uint32_t> indexes;
+
+    for(uint32_t i = 0; i < Functions.size(); ++i)
+        indexes[Functions[i]] = i;
+
+    Callees.resize(Functions.size());
+
+    for(uint32_t i = 0; i < Functions.size(); ++i) {
+        for(const auto& call : Functions[i]->GetCalls()) {
+            const auto callee = registry.FindFunction(call.Function);
+
+            if(callee)
+                Callees[i].push_back(indexes[callee]);
+        }
+
+        std::sort(Callees[i].begin(), Callees[i].end());
+        Callees[i].erase(std::unique(Callees[i].begin(), Callees[i].end()), Callees[i].end());
+    }
+
+    FindComponents();
+    ComputeLevels();
+}
+// ------------------------------------ //
+std::vector<bool> CallGraph::FindReachable(uint32_t root) const
+{
+    std::vector<bool> reachable(Functions.size(), false);
+    std::vector<uint32_t> stack{root};
+    reachable[root] = true;
+
+    while(!stack.empty()) {
+        const auto function = stack.back();
+        stack.pop_back();
+
+        for(const auto callee : Callees[function]) {
+            if(!reachable[callee]) {
+                reachable[callee] = true;
+                stack.push_back(callee);
+            }
+        }
+    }
+
+    return reachable;
+}
+// ------------------------------------ //
+void CallGraph::FindComponents()
+{
+    constexpr auto UNVISITED = std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint32_t> index(Functions.size(), UNVISITED);
+    std::vector<uint32_t> lowLink(Functions.size(), 0);
+    std::vector<bool> onStack(Functions.size(), false);
+    std::vector<uint32_t> stack;
+    uint32_t nextIndex = 0;
+
+    ComponentOf.assign(Functions.size(), 0);
+
+    // The recursion is done with an explicit stack of (function, next callee to visit) as
+    // call chains can be deep
+    std::vector<std::tuple<uint32_t, size_t>> work;
+
+    for(uint32_t root = 0; root < Functions.size(); ++root) {
+        if(index[root] != UNVISITED)
+            continue;
+
+        work.emplace_back(root, 0);
+
+        while(!work.empty()) {
+            auto& [function, nextCallee] = work.back();
+
+            if(nextCallee == 0 && index[function] == UNVISITED) {
+                index[function] = lowLink[function] = nextIndex++;
+                stack.push_back(function);
+                onStack[function] = true;
+            }
+
+            const auto& callees = Callees[function];
+
+            if(nextCallee < callees.size()) {
+                const auto callee = callees[nextCallee++];
+
+                if(index[callee] == UNVISITED) {
+                    work.emplace_back(callee, 0);
+                } else if(onStack[callee]) {
+                    lowLink[function] = std::min(lowLink[function], index[callee]);
+                }
+
+                continue;
+            }
+
+            // All callees are done, function is the root of a component if nothing it
+            // reaches is lower on the stack
+            const auto done = function;
+            work.pop_back();
+
+            if(!work.empty()) {
+                const auto caller = std::get<0>(work.back());
+                lowLink[caller] = std::min(lowLink[caller], lowLink[done]);
+            }
+
+            if(lowLink[done] != index[done])
+                continue;
+
+            std::vector<uint32_t> members;
+            uint32_t member;
+
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = false;
+                ComponentOf[member] = static_cast<uint32_t>(Components.size());
+                members.push_back(member);
+            } while(member != done);
+
+            std::sort(members.begin(), members.end());
+            Components.push_back(std::move(members));
+        }
+    }
+}
+
+void CallGraph::ComputeLevels()
+{
+    std::vector<uint32_t> levels(Components.size(), 0);
+
+    // Callees are found before their callers so their levels are already known
+    for(uint32_t component = 0; component < Components.size(); ++component) {
+        for(const auto member : Components[component]) {
+            for(const auto callee : Callees[member]) {
+                const auto calleeComponent = ComponentOf[callee];
+
+                if(calleeComponent != component) {
+                    levels[component] =
+                        std::max(levels[component], levels[calleeComponent] + 1);
+                }
+            }
+        }
+
+        if(levels[component] >= Levels.size())
+            Levels.resize(levels[component] + 1);
+
+        Levels[levels[component]].push_back(component);
+    }
+}
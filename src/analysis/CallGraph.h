@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace smacpp {
+
+class BlockRegistry;
+class CodeBlock;
+
+//! \brief Calls between the functions of a BlockRegistry and their strongly connected
+//! components
+//!
+//! Each component is a set of mutually recursive functions. The components form a DAG which
+//! is split into levels: a component only calls components on lower levels, so the levels
+//! can be analysed bottom up with all the components of a level in parallel
+class CallGraph {
+public:
+    explicit CallGraph(const BlockRegistry& registry);
+
+    //! \returns All functions sorted by name, the indexes into this are used everywhere else
+    const std::vector<const CodeBlock*>& GetFunctions() const
+    {
+        return Functions;
+    }
+
+    //! \returns The functions function calls, without duplicates and calls to functions
+    //! that aren't in the registry
+    const std::vector<uint32_t>& GetCallees(uint32_t function) const
+    {
+        return Callees[function];
+    }
+
+    uint32_t GetComponent(uint32_t function) const
+    {
+        return ComponentOf[function];
+    }
+
+    //! \returns The functions of a component
+    const std::vector<uint32_t>& GetMembers(uint32_t component) const
+    {
+        return Components[component];
+    }
+
+    size_t GetComponentCount() const
+    {
+        return Components.size();
+    }
+
+    //! \returns The components of each level, level 0 only calls functions in the same
+    //! component
+    const std::vector<std::vector<uint32_t>>& GetLevels() const
+    {
+        return Levels;
+    }
+
+    //! \returns For each function whether root calls it directly or through other
+    //! functions, root itself is included
+    std::vector<bool> FindReachable(uint32_t root) const;
+
+private:
+    //! \brief Finds the components with Tarjan's algorithm
+    //!
+    //! The components are found callees first, which is a reverse topological order
+    void FindComponents();
+
+    void ComputeLevels();
+
+private:
+    std::vector<const CodeBlock*> Functions;
+    std::vector<std::vector<uint32_t>> Callees;
+
+    std::vector<uint32_t> ComponentOf;
+
+    //! In the order Tarjan's algorithm finds them
+    std::vector<std::vector<uint32_t>> Components;
+    std::vector<std::vector<uint32_t>> Levels;
+};
+
+} // namespace smacpp
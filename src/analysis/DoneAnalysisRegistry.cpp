@@ -0,0 +1,105 @@
+// ------------------------------------ //
+#include "DoneAnalysisRegistry.h"
+
+#include "parse/Hashing.h"
+
+using namespace smacpp;
+// ------------------------------------ //
+bool DoneAnalysisRegistry::HasBeenDone(
+    const CodeBlock* func, const std::vector<VariableState>& params) const
+{
+    const auto call = MakeCall(func, params);
+    const Shard& shard = GetShard(call);
+
+    std::lock_guard<std::mutex> lock(shard.Mutex);
+    return shard.Calls.find(call) != shard.Calls.end();
+}
+
+void DoneAnalysisRegistry::Add(const CodeBlock* func, const std::vector<VariableState>& params)
+{
+    CheckAndAdd(func, params);
+}
+
+bool DoneAnalysisRegistry::CheckAndAdd(
+    const CodeBlock* func, const std::vector<VariableState>& params)
+{
+    auto call = MakeCall(func, params);
+    Shard& shard = GetShard(call);
+
+    // The insert does the check so this is a single lookup under a single lock
+    std::lock_guard<std::mutex> lock(shard.Mutex);
+    return shard.Calls.insert(std::move(call)).second;
+}
+
+std::optional<std::vector<VariableState>> DoneAnalysisRegistry::AddCall(
+    const CodeBlock* func, const std::vector<VariableState>& params)
+{
+    // Repeated tuples are rejected here without touching the per function lock
+    if(!CheckAndAdd(func, params))
+        return std::nullopt;
+
+    if(ContextLimit == 0)
+        return params;
+
+    FunctionContexts& contexts = GetContexts(func);
+    std::lock_guard<std::mutex> lock(contexts.Mutex);
+
+    auto joined = params;
+
+    // Past the limit the join is widened so that growing intervals don't need an analysis
+    // for each new value
+    const bool widen = contexts.Count >= ContextLimit;
+
+    if(contexts.Count != 0) {
+        for(size_t i = 0; i < joined.size() && i < contexts.Joined.size(); ++i) {
+            joined[i] = widen ? VariableState::Widen(contexts.Joined[i], joined[i]) :
+                                VariableState::Join(contexts.Joined[i], joined[i]);
+        }
+    }
+
+    const bool wider = joined != contexts.Joined;
+    contexts.Joined = std::move(joined);
+    ++contexts.Count;
+
+    if(contexts.Count <= ContextLimit)
+        return params;
+
+    // Once widened a new tuple only needs an analysis if it made the join wider
+    if(contexts.Widened && !wider)
+        return std::nullopt;
+
+    contexts.Widened = true;
+    return contexts.Joined;
+}
+// ------------------------------------ //
+size_t DoneAnalysisRegistry::GetCallCount() const
+{
+    size_t count = 0;
+
+    for(const auto& shard : Shards) {
+        std::lock_guard<std::mutex> lock(shard.Mutex);
+        count += shard.Calls.size();
+    }
+
+    return count;
+}
+// ------------------------------------ //
+DoneAnalysisRegistry::FunctionContexts& DoneAnalysisRegistry::GetContexts(
+    const CodeBlock* func)
+{
+    auto& shard = FunctionShards[MixHash(std::hash<const CodeBlock*>()(func)) % SHARD_COUNT];
+
+    // The map nodes are stable so the reference stays valid after unlocking
+    std::lock_guard<std::mutex> lock(shard.Mutex);
+    return shard.Functions[func];
+}
+
+DoneAnalysisRegistry::RecordedCall DoneAnalysisRegistry::MakeCall(
+    const CodeBlock* func, const std::vector<VariableState>& params)
+{
+    // The vector hash doesn't mix its bits so it is mixed again to spread it over the shards
+    const auto hash = MixHash(CombineHash(std::hash<const CodeBlock*>()(func),
+        std::hash<std::vector<VariableState>>()(params)));
+
+    return RecordedCall{hash, func, params};
+}
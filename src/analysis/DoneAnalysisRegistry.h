@@ -0,0 +1,132 @@
+#pragma once
+
+#include "parse/Variable.h"
+
+#include <array>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace smacpp {
+
+class CodeBlock;
+
+//! Makes sure each codeblock is not analysed multiple times
+//!
+//! All methods are thread safe so that the parallel analysis workers can share a registry.
+//! The calls are split into shards by the hash of the function and parameters, each with
+//! its own lock, so workers only contend when they happen to record calls in the same shard.
+//! As the parameters are part of the shard hash a single often called function is spread
+//! over all the shards
+//!
+//! To bound the work a function that has been called with more than the context limit of
+//! distinct parameter tuples is analysed with the widened join of all its tuples instead.
+//! After the first widened analysis a call is only analysed again if it makes the join
+//! wider, and each parameter can only get wider three times: its low bound to the type
+//! minimum, its high bound to the type maximum and then to unknown. So each function is
+//! analysed at most the context limit plus three times its parameter count plus one times
+//!
+//! The first tuples to arrive are the ones analysed exactly, so when multiple threads add
+//! calls the result depends on the thread timing. The context limit needs to be disabled
+//! for the parallel analysis to be deterministic
+class DoneAnalysisRegistry {
+public:
+    bool HasBeenDone(const CodeBlock* func, const std::vector<VariableState>& params) const;
+    void Add(const CodeBlock* func, const std::vector<VariableState>& params);
+
+    //! \brief Adds a call to the registry if it wasn't already added
+    //! \returns True if the func call was not in the registry and was added. Only one of
+    //! multiple threads adding the same call at the same time gets true
+    bool CheckAndAdd(const CodeBlock* func, const std::vector<VariableState>& params);
+
+    //! \brief Records a call and applies the context limit
+    //! \returns The parameters to analyse the call with, these are the widened ones if the
+    //! context limit of func has been reached. Nothing if an analysis that covers the call
+    //! has already been returned
+    std::optional<std::vector<VariableState>> AddCall(
+        const CodeBlock* func, const std::vector<VariableState>& params);
+
+    //! \brief Sets how many distinct parameter tuples are analysed per function before
+    //! they are widened, 0 disables widening
+    void SetContextLimit(size_t limit)
+    {
+        ContextLimit = limit;
+    }
+
+    //! \returns The number of recorded calls
+    size_t GetCallCount() const;
+
+private:
+    struct RecordedCall {
+        //! Hash of Function and Params, computed once for picking the shard and the set
+        //! bucket
+        std::size_t Hash;
+        const CodeBlock* Function;
+        std::vector<VariableState> Params;
+
+        bool operator==(const RecordedCall& other) const
+        {
+            return Hash == other.Hash && Function == other.Function && Params == other.Params;
+        }
+    };
+
+    struct CallHash {
+        std::size_t operator()(const RecordedCall& call) const
+        {
+            return call.Hash;
+        }
+    };
+
+    //! Aligned so that the locks of different shards aren't on the same cache line
+    struct alignas(64) Shard {
+        mutable std::mutex Mutex;
+        std::unordered_set<RecordedCall, CallHash> Calls;
+    };
+
+    //! Context limit bookkeeping of a single function
+    struct FunctionContexts {
+        std::mutex Mutex;
+
+        //! Number of distinct tuples recorded
+        size_t Count = 0;
+
+        //! Join of all the recorded tuples
+        std::vector<VariableState> Joined;
+
+        //! Set once Joined has been returned for analysis
+        bool Widened = false;
+    };
+
+    struct alignas(64) FunctionShard {
+        std::mutex Mutex;
+        std::unordered_map<const CodeBlock*, FunctionContexts> Functions;
+    };
+
+    static constexpr size_t SHARD_COUNT = 64;
+
+    static RecordedCall MakeCall(
+        const CodeBlock* func, const std::vector<VariableState>& params);
+
+    Shard& GetShard(const RecordedCall& call)
+    {
+        return Shards[call.Hash % SHARD_COUNT];
+    }
+
+    const Shard& GetShard(const RecordedCall& call) const
+    {
+        return Shards[call.Hash % SHARD_COUNT];
+    }
+
+    //! \returns The context bookkeeping of func, created if it doesn't exist
+    FunctionContexts& GetContexts(const CodeBlock* func);
+
+private:
+    std::array<Shard, SHARD_COUNT> Shards;
+    std::array<FunctionShard, SHARD_COUNT> FunctionShards;
+
+    size_t ContextLimit = 64;
+};
+
+} // namespace smacpp
@@ -0,0 +1,108 @@
+// ------------------------------------ //
+#include "EvaluationMemo.h"
+
+#include "Analyzer.h"
+
+#include <algorithm>
+
+using namespace smacpp;
+// ------------------------------------ //
+namespace {
+
+std::shared_ptr<const std::vector<VariableIdentifier>> SortInputs(
+    std::vector<VariableIdentifier>&& inputs)
+{
+    std::sort(inputs.begin(), inputs.end(),
+        [](const VariableIdentifier& lhs, const VariableIdentifier& rhs) {
+            return lhs.ID < rhs.ID;
+        });
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+    return std::make_shared<const std::vector<VariableIdentifier>>(std::move(inputs));
+}
+
+} // namespace
+// ------------------------------------ //
+TRI_STATE EvaluationMemo::MatchesCondition(
+    const Condition& condition, const ProgramState& state)
+{
+    if(condition.IsAlwaysTrue())
+        return TRI_STATE::True;
+
+    const auto* found = Conditions.Find(condition.GetNodeID());
+
+    if(found && IsValid(**found, state)) {
+        ++Hits;
+        return (*found)->Result;
+    }
+
+    std::shared_ptr<const std::vector<VariableIdentifier>> inputs;
+
+    if(found) {
+        inputs = (*found)->Inputs;
+    } else {
+        std::vector<VariableIdentifier> variables;
+        condition.CollectVariables(variables);
+        inputs = SortInputs(std::move(variables));
+    }
+
+    ++Misses;
+    const auto result = condition.Evaluate(state);
+    Conditions.Set(condition.GetNodeID(), MakeEntry(std::move(inputs), result, state));
+    return result;
+}
+
+VariableState EvaluationMemo::Resolve(const VariableState& value, const ProgramState& state)
+{
+    if(value.State != VariableState::STATE::Compute)
+        return value.Resolve(state);
+
+    const auto* found = Expressions.Find(value.GetExpressionID());
+
+    if(found && IsValid(**found, state)) {
+        ++Hits;
+        return (*found)->Result;
+    }
+
+    std::shared_ptr<const std::vector<VariableIdentifier>> inputs;
+
+    if(found) {
+        inputs = (*found)->Inputs;
+    } else {
+        std::vector<VariableIdentifier> variables;
+        value.CollectVariables(variables);
+        inputs = SortInputs(std::move(variables));
+    }
+
+    ++Misses;
+    const auto result = value.Resolve(state);
+    Expressions.Set(value.GetExpressionID(), MakeEntry(std::move(inputs), result, state));
+    return result;
+}
+// ------------------------------------ //
+template<class T>
+bool EvaluationMemo::IsValid(const Entry<T>& entry, const ProgramState& state) const
+{
+    const auto& inputs = *entry.Inputs;
+
+    for(size_t i = 0; i < inputs.size(); ++i) {
+        if(state.GetVariableVersion(inputs[i]) != entry.Versions[i])
+            return false;
+    }
+
+    return true;
+}
+
+template<class T>
+EvaluationMemo::EntryPtr<T> EvaluationMemo::MakeEntry(
+    std::shared_ptr<const std::vector<VariableIdentifier>> inputs, T result,
+    const ProgramState& state)
+{
+    std::vector<uint32_t> versions;
+    versions.reserve(inputs->size());
+
+    for(const auto& input : *inputs)
+        versions.push_back(state.GetVariableVersion(input));
+
+    return std::make_shared<const Entry<T>>(Entry<T>{std::move(inputs), std::move(versions),
+        std::move(result)});
+}
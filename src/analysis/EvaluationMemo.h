@@ -0,0 +1,72 @@
+#pragma once
+
+#include "PersistentIntMap.h"
+
+#include "parse/Condition.h"
+
+#include <memory>
+#include <vector>
+
+namespace smacpp {
+
+class ProgramState;
+
+//! \brief Caches condition and expression results of a single AnalysisOperation
+//!
+//! Each result is stored with the versions its input variables had when it was computed.
+//! As ProgramState gives each write a unique version the result is still valid if the
+//! versions are the same, so writes to the inputs invalidate the entries without any
+//! bookkeeping on the write side.
+//!
+//! The entries are kept in persistent maps so copying the memo when an operation forks is
+//! O(1), the forks then share the entries until they compute new results
+class EvaluationMemo {
+public:
+    //! \brief Evaluates condition against state or returns the cached result
+    TRI_STATE MatchesCondition(const Condition& condition, const ProgramState& state);
+
+    //! \brief Resolves value against state, computations are cached
+    VariableState Resolve(const VariableState& value, const ProgramState& state);
+
+    size_t GetHitCount() const
+    {
+        return Hits;
+    }
+
+    size_t GetMissCount() const
+    {
+        return Misses;
+    }
+
+private:
+    template<class T>
+    struct Entry {
+        //! Sorted unique variables the result depends on, shared by the recomputed entries
+        std::shared_ptr<const std::vector<VariableIdentifier>> Inputs;
+
+        //! Versions of Inputs when Result was computed
+        std::vector<uint32_t> Versions;
+        T Result;
+    };
+
+    template<class T>
+    using EntryPtr = std::shared_ptr<const Entry<T>>;
+
+    //! \returns True if entry has a result computed with the current versions of its inputs
+    template<class T>
+    bool IsValid(const Entry<T>& entry, const ProgramState& state) const;
+
+    //! \returns A new entry with result and the current versions of inputs
+    template<class T>
+    static EntryPtr<T> MakeEntry(std::shared_ptr<const std::vector<VariableIdentifier>> inputs,
+        T result, const ProgramState& state);
+
+private:
+    PersistentIntMap<EntryPtr<TRI_STATE>> Conditions;
+    PersistentIntMap<EntryPtr<VariableState>> Expressions;
+
+    size_t Hits = 0;
+    size_t Misses = 0;
+};
+
+} // namespace smacpp
@@ -0,0 +1,94 @@
+// ------------------------------------ //
+#include "FunctionSummary.h"
+
+#include "parse/Hashing.h"
+
+using namespace smacpp;
+// ------------------------------------ //
+// SummaryBuilder
+void SummaryBuilder::AddPath()
+{
+    std::lock_guard<std::mutex> lock(Mutex);
+    ++PendingPaths;
+}
+
+void SummaryBuilder::FinishPath(std::vector<FoundProblem>&& problems,
+    std::vector<CalledFunction>&& calls, const PersistentIntMap<VariableState>& globals,
+    SummaryCache& cache)
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    Summary.Problems.insert(Summary.Problems.end(), problems.begin(), problems.end());
+    Summary.Calls.insert(Summary.Calls.end(), calls.begin(), calls.end());
+
+    if(FirstPath) {
+        Summary.Globals = globals;
+        FirstPath = false;
+    } else {
+        PersistentIntMap<VariableState> joined;
+
+        Summary.Globals.ForEach([&](uint32_t key, const VariableState& value) {
+            const auto other = globals.Find(key);
+            joined.Set(key, other ? VariableState::Join(value, *other) : VariableState());
+        });
+
+        globals.ForEach([&](uint32_t key, const VariableState&) {
+            if(!Summary.Globals.Find(key))
+                joined.Set(key, VariableState());
+        });
+
+        Summary.Globals = std::move(joined);
+    }
+
+    if(--PendingPaths != 0)
+        return;
+
+    auto summary = std::make_shared<const FunctionSummary>(std::move(Summary));
+    lock.unlock();
+
+    cache.Insert(Function, Params, std::move(summary));
+}
+// ------------------------------------ //
+// SummaryCache
+std::shared_ptr<const FunctionSummary> SummaryCache::Find(
+    const CodeBlock* function, const std::vector<VariableState>& params) const
+{
+    std::shared_lock lock(Mutex);
+
+    const auto found = Summaries.find(Key{function, params});
+
+    if(found == Summaries.end())
+        return nullptr;
+
+    ++Hits;
+    return found->second;
+}
+
+void SummaryCache::Insert(const CodeBlock* function, const std::vector<VariableState>& params,
+    std::shared_ptr<const FunctionSummary> summary)
+{
+    std::unique_lock lock(Mutex);
+    Unpublished.insert_or_assign(Key{function, params}, std::move(summary));
+}
+
+void SummaryCache::Publish()
+{
+    std::unique_lock lock(Mutex);
+
+    for(auto& [key, summary] : Unpublished)
+        Summaries.insert_or_assign(key, std::move(summary));
+
+    Unpublished.clear();
+}
+
+size_t SummaryCache::GetSize() const
+{
+    std::shared_lock lock(Mutex);
+    return Summaries.size();
+}
+// ------------------------------------ //
+std::size_t SummaryCache::KeyHash::operator()(const Key& key) const
+{
+    return CombineHash(MixHash(reinterpret_cast<uintptr_t>(key.Function)),
+        std::hash<std::vector<VariableState>>()(key.Params));
+}
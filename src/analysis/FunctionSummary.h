@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Analyzer.h"
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace smacpp {
+
+//! \brief What analysing a function with one parameter tuple found
+//!
+//! The problems in the called functions aren't copied here, they are found by following
+//! Calls to the summaries of the callees
+struct FunctionSummary {
+    //! Problems found in the function itself
+    std::vector<FoundProblem> Problems;
+
+    //! The called functions and the parameters resolved in this function
+    std::vector<CalledFunction> Calls;
+
+    //! Values of the globals the function has written when it returns, joined over all the
+    //! paths. A global only some paths write is unknown. These are written to the state of
+    //! the callers after the call
+    PersistentIntMap<VariableState> Globals;
+};
+
+class SummaryCache;
+
+//! \brief Collects the summary of a function from all the paths its analysis forks into
+//!
+//! The paths can be run by different workers so this is thread safe. The summary is added
+//! to the cache once the last path finishes
+class SummaryBuilder {
+public:
+    SummaryBuilder(const CodeBlock* function, std::vector<VariableState> params) :
+        Function(function), Params(std::move(params))
+    {}
+
+    //! \brief Registers a path forked from one of the existing paths
+    void AddPath();
+
+    //! \brief Adds what a finished path found
+    void FinishPath(std::vector<FoundProblem>&& problems, std::vector<CalledFunction>&& calls,
+        const PersistentIntMap<VariableState>& globals, SummaryCache& cache);
+
+private:
+    const CodeBlock* Function;
+    const std::vector<VariableState> Params;
+
+    std::mutex Mutex;
+    size_t PendingPaths = 1;
+    bool FirstPath = true;
+    FunctionSummary Summary;
+};
+
+//! \brief Finished function summaries shared by the analyses of the bottom up analysis
+//!
+//! A call that has a summary doesn't need to be analysed again, the problems in the summary
+//! are reported and its calls are followed instead. The top down analysis doesn't use these
+//! as its registry already makes sure each call is only analysed once
+//!
+//! New summaries only become visible once they are published. The bottom up analysis
+//! publishes them between the levels, so the analyses of a level only see the summaries of
+//! the lower levels and their results don't depend on which analyses finish first
+class SummaryCache {
+public:
+    //! \returns The published summary of function called with params or null
+    std::shared_ptr<const FunctionSummary> Find(
+        const CodeBlock* function, const std::vector<VariableState>& params) const;
+
+    //! \brief Adds a summary that becomes visible on the next Publish
+    void Insert(const CodeBlock* function, const std::vector<VariableState>& params,
+        std::shared_ptr<const FunctionSummary> summary);
+
+    //! \brief Makes the summaries inserted since the last call visible to Find
+    void Publish();
+
+    //! \returns The number of published summaries
+    size_t GetSize() const;
+
+    //! \returns The number of Find calls that found a summary
+    size_t GetHitCount() const
+    {
+        return Hits;
+    }
+
+private:
+    struct Key {
+        const CodeBlock* Function;
+        std::vector<VariableState> Params;
+
+        bool operator==(const Key& other) const
+        {
+            return Function == other.Function && Params == other.Params;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+
+private:
+    std::unordered_map<Key, std::shared_ptr<const FunctionSummary>, KeyHash> Summaries;
+    std::unordered_map<Key, std::shared_ptr<const FunctionSummary>, KeyHash> Unpublished;
+
+    mutable std::shared_mutex Mutex;
+    mutable std::atomic<size_t> Hits{0};
+};
+
+} // namespace smacpp
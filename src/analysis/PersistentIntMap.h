@@ -0,0 +1,261 @@
+#pragma once
+
+#include "parse/Hashing.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace smacpp {
+
+//! \brief Persistent radix tree map from 32-bit ids to values
+//!
+//! Copying a map is O(1) as the nodes are shared between the copies. Set copies only the
+//! nodes on the path to the changed key, so updating is O(log n) and leaves every other copy
+//! unchanged. Each node caches a hash of its contents, which makes hashing O(1) and lets
+//! equality skip shared subtrees.
+template<class Value, class ValueHash = std::hash<Value>>
+class PersistentIntMap {
+    static constexpr uint32_t BITS = 4;
+    static constexpr uint32_t WIDTH = 1 << BITS;
+    static constexpr uint32_t MASK = WIDTH - 1;
+
+    struct Node {
+        //! Bit i is set if entry i has a value or a child
+        uint16_t Present = 0;
+        bool Leaf = true;
+        std::size_t Hash = 0;
+    };
+
+    struct LeafNode : Node {
+        std::array<Value, WIDTH> Values;
+    };
+
+    struct InnerNode : Node {
+        std::array<std::shared_ptr<const Node>, WIDTH> Children;
+    };
+
+    using NodePtr = std::shared_ptr<const Node>;
+
+public:
+    //! \returns The stored value or null
+    const Value* Find(uint32_t key) const
+    {
+        if(!Root || key >= Capacity())
+            return nullptr;
+
+        const Node* node = Root.get();
+
+        for(uint32_t level = Height; level > 0; --level) {
+            const auto index = (key >> (level * BITS)) & MASK;
+
+            if(!(node->Present & (1 << index)))
+                return nullptr;
+
+            node = static_cast<const InnerNode*>(node)->Children[index].get();
+        }
+
+        const auto index = key & MASK;
+
+        if(!(node->Present & (1 << index)))
+            return nullptr;
+
+        return &static_cast<const LeafNode*>(node)->Values[index];
+    }
+
+    void Set(uint32_t key, const Value& value)
+    {
+        if(!Root) {
+            Root = std::make_shared<LeafNode>();
+            Height = 0;
+        }
+
+        // Grow the tree so that the key fits, the old root becomes the first child
+        while(key >= Capacity()) {
+            auto newRoot = std::make_shared<InnerNode>();
+            newRoot->Leaf = false;
+            newRoot->Present = 1;
+            newRoot->Children[0] = Root;
+            newRoot->Hash = HashInner(*newRoot);
+            Root = std::move(newRoot);
+            ++Height;
+        }
+
+        bool added = false;
+        Root = SetIn(Root.get(), Height, key, value, added);
+
+        if(added)
+            ++Count;
+    }
+
+    size_t Size() const
+    {
+        return Count;
+    }
+
+    bool Empty() const
+    {
+        return Count == 0;
+    }
+
+    std::size_t Hash() const
+    {
+        return Root ? CombineHash(Root->Hash, Height) : 0;
+    }
+
+    //! \brief Calls func(key, value) in key order
+    template<class Func>
+    void ForEach(Func&& func) const
+    {
+        if(Root)
+            ForEachIn(Root.get(), Height, 0, func);
+    }
+
+    bool operator==(const PersistentIntMap& other) const
+    {
+        if(Count != other.Count)
+            return false;
+
+        if(!Root || !other.Root)
+            return Root == other.Root;
+
+        // Keys are never removed so the height only depends on the largest key, maps with
+        // different heights can't have the same keys
+        if(Height != other.Height)
+            return false;
+
+        return NodesEqual(Root.get(), other.Root.get(), Height);
+    }
+
+    bool operator!=(const PersistentIntMap& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    uint64_t Capacity() const
+    {
+        return uint64_t(1) << ((Height + 1) * BITS);
+    }
+
+    static NodePtr SetIn(
+        const Node* node, uint32_t level, uint32_t key, const Value& value, bool& added)
+    {
+        const auto index = (key >> (level * BITS)) & MASK;
+
+        if(level == 0) {
+            auto copy = std::make_shared<LeafNode>(*static_cast<const LeafNode*>(node));
+
+            if(!(copy->Present & (1 << index)))
+                added = true;
+
+            copy->Present |= 1 << index;
+            copy->Values[index] = value;
+            copy->Hash = HashLeaf(*copy);
+            return copy;
+        }
+
+        auto copy = std::make_shared<InnerNode>(*static_cast<const InnerNode*>(node));
+
+        if(copy->Present & (1 << index)) {
+            copy->Children[index] =
+                SetIn(copy->Children[index].get(), level - 1, key, value, added);
+        } else {
+            copy->Children[index] = SetIn(EmptyNode(level - 1).get(), level - 1, key, value,
+                added);
+            copy->Present |= 1 << index;
+        }
+
+        copy->Hash = HashInner(*copy);
+        return copy;
+    }
+
+    static NodePtr EmptyNode(uint32_t level)
+    {
+        if(level == 0)
+            return std::make_shared<LeafNode>();
+
+        auto node = std::make_shared<InnerNode>();
+        node->Leaf = false;
+        return node;
+    }
+
+    static std::size_t HashLeaf(const LeafNode& node)
+    {
+        std::size_t result = MixHash(node.Present);
+
+        for(uint32_t i = 0; i < WIDTH; ++i) {
+            if(node.Present & (1 << i))
+                result = CombineHash(result, ValueHash()(node.Values[i]));
+        }
+
+        return result;
+    }
+
+    static std::size_t HashInner(const InnerNode& node)
+    {
+        std::size_t result = MixHash(node.Present);
+
+        for(uint32_t i = 0; i < WIDTH; ++i) {
+            if(node.Present & (1 << i))
+                result = CombineHash(result, node.Children[i]->Hash);
+        }
+
+        return result;
+    }
+
+    static bool NodesEqual(const Node* first, const Node* second, uint32_t level)
+    {
+        // Shared subtrees are equal without looking into them
+        if(first == second)
+            return true;
+
+        if(first->Present != second->Present || first->Hash != second->Hash)
+            return false;
+
+        for(uint32_t i = 0; i < WIDTH; ++i) {
+            if(!(first->Present & (1 << i)))
+                continue;
+
+            if(level == 0) {
+                if(!(static_cast<const LeafNode*>(first)->Values[i] ==
+                       static_cast<const LeafNode*>(second)->Values[i]))
+                    return false;
+            } else {
+                if(!NodesEqual(static_cast<const InnerNode*>(first)->Children[i].get(),
+                       static_cast<const InnerNode*>(second)->Children[i].get(), level - 1))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    template<class Func>
+    static void ForEachIn(const Node* node, uint32_t level, uint32_t prefix, Func& func)
+    {
+        for(uint32_t i = 0; i < WIDTH; ++i) {
+            if(!(node->Present & (1 << i)))
+                continue;
+
+            const auto key = (prefix << BITS) | i;
+
+            if(level == 0) {
+                func(key, static_cast<const LeafNode*>(node)->Values[i]);
+            } else {
+                const auto child = static_cast<const InnerNode*>(node)->Children[i].get();
+                ForEachIn(child, level - 1, key, func);
+            }
+        }
+    }
+
+private:
+    NodePtr Root;
+
+    //! Number of inner node levels above the leaves
+    uint32_t Height = 0;
+    size_t Count = 0;
+};
+
+} // namespace smacpp
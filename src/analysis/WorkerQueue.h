@@ -0,0 +1,55 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace smacpp {
+
+//! \brief Work queue of a single worker thread that other workers can steal from
+//!
+//! The owner pushes and pops at the back so it works depth first on the operations it
+//! found most recently, which are likely to still be in its cache. Thieves take the oldest
+//! operations from the front, these tend to fan out into the most new work. Operations take
+//! far longer than the queue accesses so a plain mutex is enough
+template<class T>
+class WorkerQueue {
+public:
+    void PushBack(T&& item)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Items.push_back(std::move(item));
+    }
+
+    //! \brief Takes the newest item, used by the owner
+    std::optional<T> PopBack()
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+
+        if(Items.empty())
+            return std::nullopt;
+
+        std::optional<T> item(std::move(Items.back()));
+        Items.pop_back();
+        return item;
+    }
+
+    //! \brief Takes the oldest item, used by the other workers
+    std::optional<T> StealFront()
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+
+        if(Items.empty())
+            return std::nullopt;
+
+        std::optional<T> item(std::move(Items.front()));
+        Items.pop_front();
+        return item;
+    }
+
+private:
+    std::mutex Mutex;
+    std::deque<T> Items;
+};
+
+} // namespace smacpp
@@ -13,7 +13,7 @@ protected:
     std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
         clang::CompilerInstance& Compiler, llvm::StringRef InFile) override
     {
-        return std::make_unique<MainASTConsumer>(EnableDebugPrint
+        return std::make_unique<MainASTConsumer>(Options
             // Compiler.getASTContext()
         );
     }
@@ -21,11 +21,64 @@ protected:
     bool ParseArgs(
         const clang::CompilerInstance& CI, const std::vector<std::string>& args) override
     {
+        bool contextLimitSet = false;
+        bool forkOptionSet = false;
+
         for(size_t i = 0; i < args.size(); ++i) {
-            if(args[i] == "-smacpp-debug") {
-                EnableDebugPrint = true;
+            llvm::StringRef arg(args[i]);
+
+            // Set for the arguments that take a number after "="
+            size_t* number = nullptr;
+
+            if(arg == "-smacpp-debug") {
+                Options.Debug = true;
+            } else if(arg == "-smacpp-depth-first") {
+                Options.DepthFirst = true;
+            } else if(arg == "-smacpp-ssa") {
+                Options.SSA = true;
+            } else if(arg == "-smacpp-bottom-up") {
+                Options.BottomUp = true;
+            } else if(arg.consume_front("-smacpp-jobs=")) {
+                number = &Options.Jobs;
+            } else if(arg.consume_front("-smacpp-fork-depth=")) {
+                number = &Options.ForkDepthLimit;
+                forkOptionSet = true;
+            } else if(arg.consume_front("-smacpp-path-budget=")) {
+                number = &Options.PathBudget;
+                forkOptionSet = true;
+            } else if(arg.consume_front("-smacpp-context-limit=")) {
+                number = &Options.ContextLimit;
+                contextLimitSet = true;
+            }
+
+            if(number && arg.getAsInteger(10, *number)) {
+                llvm::errs() << "smacpp: invalid number in argument: " << args[i] << "\n";
+                return false;
+            }
+        }
+
+        if(Options.Jobs == 0) {
+            llvm::errs() << "smacpp: job count needs to be at least 1\n";
+            return false;
+        }
+
+        // Which calls are widened depends on the order the workers find them in
+        if(Options.Jobs > 1) {
+            if(contextLimitSet && Options.ContextLimit != 0) {
+                llvm::errs() << "smacpp: the context limit can't be used with more than one "
+                                "job, set it to 0 to disable it\n";
+                return false;
             }
+
+            Options.ContextLimit = 0;
         }
+
+        // The SSA form is run as a single path, the unknown guards aren't taken
+        if(Options.SSA && !Options.DepthFirst && forkOptionSet) {
+            llvm::errs() << "smacpp: warning: -smacpp-ssa doesn't fork on unknown conditions, "
+                            "-smacpp-fork-depth and -smacpp-path-budget are ignored\n";
+        }
+
         if(!args.empty() && args[0] == "help")
             PrintHelp(llvm::errs());
 
@@ -35,7 +88,16 @@ protected:
     void PrintHelp(llvm::raw_ostream& ros)
     {
         ros << "SMACPP Clang plugin:\n"
-            << "-smacpp-debug Enables debug printing\n";
+            << "-smacpp-debug Enables debug printing\n"
+            << "-smacpp-depth-first Explores paths depth first with an undo trail\n"
+            << "-smacpp-ssa Analyses functions in SSA form, unknown conditions are not taken\n"
+            << "-smacpp-bottom-up Summarises the functions main reaches bottom up over the "
+               "call graph before analysing main\n"
+            << "-smacpp-jobs=N Runs the analysis on N threads\n"
+            << "-smacpp-fork-depth=N Unknown conditions a single path can fork on\n"
+            << "-smacpp-path-budget=N Total forks on unknown conditions per function call\n"
+            << "-smacpp-context-limit=N Parameter tuples per function before widening, 0 "
+               "disables widening. Only 0 is allowed with -smacpp-jobs above 1\n";
     }
 
     //! This should automatically run the plugin after the main AST action when usinf -fplugin=
@@ -46,6 +108,6 @@ protected:
     }
 
 protected:
-    bool EnableDebugPrint = false;
+    AnalysisOptions Options;
 };
 } // namespace smacpp
@@ -10,6 +10,6 @@ using namespace smacpp;
 std::unique_ptr<clang::ASTConsumer> FrontendAction::CreateASTConsumer(
     clang::CompilerInstance& Compiler, llvm::StringRef InFile)
 {
-    return std::make_unique<MainASTConsumer>(false // Compiler.getASTContext()
+    return std::make_unique<MainASTConsumer>(AnalysisOptions{} // Compiler.getASTContext()
     );
 }
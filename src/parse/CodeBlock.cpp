@@ -1,13 +1,178 @@
 // ------------------------------------ //
 #include "CodeBlock.h"
 
+#include "ConditionCompiler.h"
+#include "SSAForm.h"
+
+#include <algorithm>
 #include <sstream>
 
 using namespace smacpp;
 // ------------------------------------ //
+namespace {
+
+//! \brief Collects the variables an action reads and writes
+struct AccessCollector {
+    void operator()(const action::VarDeclared& action)
+    {
+        action.State.CollectVariables(Reads);
+        Writes.push_back(action.Variable);
+    }
+
+    void operator()(const action::VarAssigned& action)
+    {
+        action.State.CollectVariables(Reads);
+        Writes.push_back(action.Variable);
+    }
+
+    void operator()(const action::ArrayIndexAccess& action)
+    {
+        Reads.push_back(action.Array);
+        action.Index.CollectVariables(Reads);
+    }
+
+    void operator()(const action::FunctionCall& action)
+    {
+        for(const auto& param : Calls[action.Call].Params)
+            param.CollectVariables(Reads);
+    }
+
+    const std::vector<action::CallInfo>& Calls;
+    std::vector<VariableIdentifier> Reads;
+    std::vector<VariableIdentifier> Writes;
+};
+
+//! \brief Writes a description of an action
+struct ActionDumper {
+    void operator()(const action::VarDeclared& var)
+    {
+        Out << "VarDeclared " << var.Variable.Dump() << " value: " << var.State.Dump();
+    }
+
+    void operator()(const action::VarAssigned& var)
+    {
+        Out << "VarAssigned " << var.Variable.Dump() << " = " << var.State.Dump();
+    }
 
+    void operator()(const action::ArrayIndexAccess& access)
+    {
+        Out << "ArrayIndexAccess " << access.Array.Dump() << "[" << access.Index.Dump() << "]";
+    }
+
+    void operator()(const action::FunctionCall& action)
+    {
+        const auto& call = Calls[action.Call];
+        Out << "FunctionCall " << call.Function << "(";
+
+        bool first = true;
+
+        for(const auto& param : call.Params) {
+            if(!first)
+                Out << ", ";
+            first = false;
+
+            Out << param.Dump();
+        }
+        Out << ")";
+    }
+
+    const std::vector<action::CallInfo>& Calls;
+    std::stringstream& Out;
+};
+
+} // namespace
 // ------------------------------------ //
 // CodeBlock
+void CodeBlock::AddProcessedAction(
+    Condition condition, ProcessedAction::Data action, clang::SourceLocation location)
+{
+    if(GroupEnded || ActionGroups.back().If != condition) {
+        const auto begin = static_cast<uint32_t>(Actions.size());
+        ActionGroups.push_back(ActionGroup{condition, AddGuard(condition), begin, begin});
+        GroupEnded = false;
+    }
+
+    AccessCollector collector{Calls, {}, {}};
+    std::visit(collector, action);
+
+    ActionAccess access;
+    access.ReadBegin = AppendDependencies(collector.Reads);
+    access.WriteBegin = AppendDependencies(collector.Writes);
+    access.WriteEnd = static_cast<uint32_t>(DependencyVariables.size());
+    ActionAccesses.push_back(access);
+
+    Actions.push_back(ProcessedAction{std::move(action)});
+    ActionLocations.push_back(location);
+    ++ActionGroups.back().End;
+    SSA.reset();
+}
+
+void CodeBlock::AddFunctionCall(Condition condition, const std::string& function,
+    const std::vector<VariableState>& params, clang::SourceLocation location)
+{
+    Calls.push_back(action::CallInfo{function, params});
+
+    AddProcessedAction(
+        condition, action::FunctionCall{static_cast<uint32_t>(Calls.size() - 1)}, location);
+}
+
+void CodeBlock::BuildSSA()
+{
+    SSA = std::make_shared<const SSAForm>(*this);
+}
+// ------------------------------------ //
+uint32_t CodeBlock::AddGuard(Condition condition)
+{
+    const auto existing = GuardIndices.find(condition);
+
+    if(existing != GuardIndices.end())
+        return existing->second;
+
+    ConditionCompiler::Get().Compile(condition);
+
+    std::vector<VariableIdentifier> reads;
+    condition.CollectVariables(reads);
+
+    GuardRead read;
+    read.Begin = AppendDependencies(reads);
+    read.End = static_cast<uint32_t>(DependencyVariables.size());
+
+    const auto index = static_cast<uint32_t>(Guards.size());
+    Guards.push_back(condition);
+    GuardReads.push_back(read);
+    GuardIndices[condition] = index;
+    return index;
+}
+
+uint32_t CodeBlock::AppendDependencies(std::vector<VariableIdentifier>& variables)
+{
+    const auto begin = static_cast<uint32_t>(DependencyVariables.size());
+
+    std::sort(variables.begin(), variables.end(),
+        [](const VariableIdentifier& lhs, const VariableIdentifier& rhs) {
+            return lhs.ID < rhs.ID;
+        });
+    variables.erase(std::unique(variables.begin(), variables.end()), variables.end());
+
+    DependencyVariables.insert(DependencyVariables.end(), variables.begin(), variables.end());
+    return begin;
+}
+// ------------------------------------ //
+SymbolTable::FrameSlot CodeBlock::AllocateFrameSlot(VariableIdentifier var)
+{
+    auto& symbols = SymbolTable::Get();
+
+    const auto existing = symbols.GetFrameSlot(var.ID);
+
+    if(existing < FrameSlots.size() && FrameSlots[existing] == var)
+        return existing;
+
+    const auto slot = static_cast<SymbolTable::FrameSlot>(FrameSlots.size());
+    FrameSlots.push_back(var);
+    symbols.SetFrameSlot(var.ID, slot);
+    return slot;
+}
+// ------------------------------------ //
 std::string CodeBlock::Dump() const
 {
     std::stringstream sstream;
@@ -19,10 +184,30 @@ std::string CodeBlock::Dump() const
         sstream << param.Dump() << " ";
     sstream << "\n";
 
+    sstream << " frame: ";
+    for(size_t i = 0; i < FrameSlots.size(); ++i)
+        sstream << "[" << i << "] " << FrameSlots[i].Dump() << " ";
+    sstream << "\n";
+
     sstream << "actions:\n";
-    for(const auto& action : Actions)
-        sstream << " " << action->Dump() << "\n";
+    for(const auto& group : ActionGroups) {
+        sstream << " group " << group.If.Dump() << "\n";
+
+        for(size_t i = group.Begin; i < group.End; ++i)
+            sstream << "  " << DumpAction(i) << "\n";
+    }
 
     sstream << "block end\n";
     return sstream.str();
 }
+
+std::string CodeBlock::DumpAction(size_t index) const
+{
+    const ProcessedAction& action = Actions[index];
+
+    std::stringstream sstream;
+
+    std::visit(ActionDumper{Calls, sstream}, action.Action);
+
+    return sstream.str();
+}
@@ -5,8 +5,40 @@
 
 #include <clang/AST/Stmt.h>
 
+#include <memory>
+#include <unordered_map>
+
 namespace smacpp {
 
+class SSAForm;
+
+//! \brief Read only view of a part of an array in a CodeBlock
+template<class T>
+struct ArrayView {
+    const T* begin() const
+    {
+        return First;
+    }
+
+    const T* end() const
+    {
+        return Last;
+    }
+
+    size_t size() const
+    {
+        return Last - First;
+    }
+
+    bool empty() const
+    {
+        return First == Last;
+    }
+
+    const T* First;
+    const T* Last;
+};
+
 //! Represents a block of source code that has properties extracted from it
 class CodeBlock {
 public:
@@ -19,18 +51,50 @@ public:
     //! Everything is bunched together like this in order to be able to determine the variable
     //! states at the potentially unsafe operations in order to verify the conditions under
     //! which they are unsafe
-    void AddProcessedAction(std::unique_ptr<ProcessedAction>&& action,
-        clang::SourceLocation location = clang::SourceLocation{})
+    //! \note This also compiles the condition of the action for faster evaluation
+    //! \note The action is added to the last ActionGroup if it has the same condition and
+    //! hasn't been ended with EndActionGroup
+    void AddProcessedAction(Condition condition, ProcessedAction::Data action,
+        clang::SourceLocation location = clang::SourceLocation{});
+
+    //! \brief Adds a FunctionCall action and its entry in the call table
+    void AddFunctionCall(Condition condition, const std::string& function,
+        const std::vector<VariableState>& params,
+        clang::SourceLocation location = clang::SourceLocation{});
+
+    //! \brief Lowers the actions to SSA form, after this GetSSA returns the result
+    //!
+    //! This needs to be called once all actions have been added, adding more actions discards
+    //! the result
+    void BuildSSA();
+
+    //! \returns The SSA form of the actions or null if BuildSSA hasn't been called
+    const SSAForm* GetSSA() const
     {
-        if(location.isValid())
-            action->Location = location;
-        Actions.push_back(std::move(action));
+        return SSA.get();
+    }
+
+    //! \brief Makes the next action start a new ActionGroup
+    //!
+    //! Needs to be called when the actions of a statement end, for example two if statements
+    //! with the same condition must not be in the same group as the first one can change the
+    //! result of the second one
+    void EndActionGroup()
+    {
+        GroupEnded = true;
     }
 
     //! \brief Register function parameter
     void AddFunctionParameter(VariableIdentifier var)
     {
         FunctionParameters.push_back(var);
+        AllocateFrameSlot(var);
+    }
+
+    //! \brief Register a local variable declared in this block
+    void AddLocalVariable(VariableIdentifier var)
+    {
+        AllocateFrameSlot(var);
     }
 
     const auto& GetActions() const
@@ -38,11 +102,68 @@ public:
         return Actions;
     }
 
+    const auto& GetActionGroups() const
+    {
+        return ActionGroups;
+    }
+
+    //! \returns The distinct guard conditions of the action groups
+    const auto& GetGuards() const
+    {
+        return Guards;
+    }
+
+    ArrayView<VariableIdentifier> GetActionReads(size_t index) const
+    {
+        const auto& access = ActionAccesses[index];
+        return MakeView(DependencyVariables, access.ReadBegin, access.WriteBegin);
+    }
+
+    ArrayView<VariableIdentifier> GetActionWrites(size_t index) const
+    {
+        const auto& access = ActionAccesses[index];
+        return MakeView(DependencyVariables, access.WriteBegin, access.WriteEnd);
+    }
+
+    ArrayView<VariableIdentifier> GetGuardReads(uint32_t guard) const
+    {
+        const auto& reads = GuardReads[guard];
+        return MakeView(DependencyVariables, reads.Begin, reads.End);
+    }
+
+    clang::SourceLocation GetActionLocation(size_t index) const
+    {
+        return ActionLocations[index];
+    }
+
+    const action::CallInfo& GetCall(uint32_t call) const
+    {
+        return Calls[call];
+    }
+
+    const auto& GetCalls() const
+    {
+        return Calls;
+    }
+
+    std::string DumpAction(size_t index) const;
+
     const auto& GetParameters() const
     {
         return FunctionParameters;
     }
 
+    //! \returns The variables of this block indexed by their frame slot
+    const auto& GetFrameSlots() const
+    {
+        return FrameSlots;
+    }
+
+    size_t GetFrameSize() const
+    {
+        return FrameSlots.size();
+    }
+
     // //! \brief Computes an overall Condition that if it matches this is unsafe to call
     // Condition ComputeUnsafeInput();
 
@@ -58,6 +179,35 @@ public:
         return Location;
     }
 
+private:
+    //! \brief Gives a parameter or a local variable a dense slot number in this block
+    SymbolTable::FrameSlot AllocateFrameSlot(VariableIdentifier var);
+
+    //! \returns The index of condition in Guards, it is added if not already there
+    uint32_t AddGuard(Condition condition);
+
+    //! \brief Adds the unique variables from variables to DependencyVariables
+    //! \returns The index of the first added variable
+    uint32_t AppendDependencies(std::vector<VariableIdentifier>& variables);
+
+    template<class T>
+    static ArrayView<T> MakeView(const std::vector<T>& data, uint32_t begin, uint32_t end)
+    {
+        return ArrayView<T>{data.data() + begin, data.data() + end};
+    }
+
+    //! Range of DependencyVariables for a single action, reads are followed by writes
+    struct ActionAccess {
+        uint32_t ReadBegin;
+        uint32_t WriteBegin;
+        uint32_t WriteEnd;
+    };
+
+    struct GuardRead {
+        uint32_t Begin;
+        uint32_t End;
+    };
+
 private:
     std::string Name;
     clang::SourceLocation Location;
@@ -65,9 +215,36 @@ private:
     //! \todo Find default values
     std::vector<VariableIdentifier> FunctionParameters;
 
+    //! Parameters and locals, the index is the slot number of the variable
+    std::vector<VariableIdentifier> FrameSlots;
+
     //! All actions in chronological order in order to be able to do symbolic execution
     //! correctly
-    std::vector<std::unique_ptr<ProcessedAction>> Actions;
+    std::vector<ProcessedAction> Actions;
+
+    //! Guards of Actions, each action belongs to exactly one group
+    std::vector<ActionGroup> ActionGroups;
+
+    //! When true the next action starts a new group even if the condition is the same
+    bool GroupEnded = true;
+
+    //! Distinct conditions of ActionGroups
+    std::vector<Condition> Guards;
+    std::unordered_map<Condition, uint32_t> GuardIndices;
+
+    //! Variables read and written by the actions and the guards. ActionAccesses is indexed
+    //! like Actions and GuardReads like Guards
+    std::vector<VariableIdentifier> DependencyVariables;
+    std::vector<ActionAccess> ActionAccesses;
+    std::vector<GuardRead> GuardReads;
+
+    std::shared_ptr<const SSAForm> SSA;
+
+    //! Source locations of Actions, indexed the same way
+    std::vector<clang::SourceLocation> ActionLocations;
+
+    //! Callees and parameters of the FunctionCall actions
+    std::vector<action::CallInfo> Calls;
 };
 
 } // namespace smacpp
@@ -6,10 +6,44 @@
 #include "ProcessedAction.h"
 #include "analysis/BlockRegistry.h"
 
+#include <algorithm>
 #include <optional>
 
 using namespace smacpp;
 // ------------------------------------ //
+namespace {
+
+//! \returns The value of an integer literal or a negated one, empty for all other expressions
+//! as their value depends on things other than the literals in them
+std::optional<PrimitiveInfo> ParseLiteralInitializer(const clang::Expr* expr)
+{
+    expr = expr->IgnoreParenImpCasts();
+
+    bool negate = false;
+
+    if(const auto* op = clang::dyn_cast<clang::UnaryOperator>(expr);
+        op && op->getOpcode() == clang::UO_Minus) {
+        negate = true;
+        expr = op->getSubExpr()->IgnoreParenImpCasts();
+    }
+
+    const auto* literal = clang::dyn_cast<clang::IntegerLiteral>(expr);
+
+    if(!literal)
+        return std::optional<PrimitiveInfo>{};
+
+    // Values wider than 128 bits are left unknown
+    auto value = PrimitiveInfo::FromAPInt(
+        literal->getValue(), literal->getType()->isSignedIntegerType());
+
+    if(value && negate)
+        value = value->Negate();
+
+    return value;
+}
+
+} // namespace
+// ------------------------------------ //
 // CodeBlockBuildingVisitor::VariableRefOrArrayVisitor
 class CodeBlockBuildingVisitor::VariableRefOrArrayVisitor
     : public clang::RecursiveASTVisitor<VariableRefOrArrayVisitor> {
@@ -140,37 +174,45 @@ public:
         BaseCondition(baseCondition), SwitchVar("unused"), SwitchConstant(constant)
     {}
 
-    bool VisitCaseStmt(clang::CaseStmt* stmt)
+    //! \brief Sets the promoted type of the controlling expression, the case values are
+    //! converted to it like in C
+    void SetConditionType(std::optional<PRIMITIVE_TYPE> type)
     {
-        if(!stmt->getLHS()) {
-            llvm::outs() << "Case statement without LHS";
-            return true;
-        }
+        ConditionType = type;
+    }
 
-        LiteralStateVisitor literal;
-        literal.TraverseStmt(stmt->getLHS());
+    //! \brief Finds all case values of a switch body, needed to build the default condition
+    //! before reaching the default label
+    void CollectCaseValues(clang::Stmt* body)
+    {
+        CaseValueCollector collector(*this);
+        collector.TraverseStmt(body);
+    }
 
-        if(!literal.FoundValue) {
-            if(Debug) {
-                llvm::outs() << "Could not parse switch case value: ";
-                stmt->getLHS()->dump();
-            }
-            return true;
-        }
+    bool VisitCaseStmt(clang::CaseStmt* stmt)
+    {
+        const auto value = ParseCaseValue(stmt);
 
-        const auto range = ValueRange(COMPARISON::EQUAL, *literal.FoundValue);
+        if(!value)
+            return true;
 
-        Condition newCondition(
-            SwitchConstant ? Condition::Part(VariableStateCondition(*SwitchConstant, range)) :
-                             Condition::Part(VariableValueCondition(SwitchVar, range)));
+        // Cases without a break in between are a group that shares a single set, after
+        // default the set holds the values that are excluded
+        if(!InCaseGroup) {
+            InCaseGroup = true;
+            IsDefaultGroup = false;
+            CurrentCases.clear();
+        }
 
-        SwitchCases.push_back(newCondition);
-        if(CurrentSwitchCondition.IsAlwaysTrue()) {
-            CurrentSwitchCondition = newCondition;
+        if(IsDefaultGroup) {
+            CurrentCases.erase(std::remove(CurrentCases.begin(), CurrentCases.end(), *value),
+                CurrentCases.end());
         } else {
-            CurrentSwitchCondition = CurrentSwitchCondition.Or(newCondition);
+            CurrentCases.push_back(*value);
         }
 
+        UpdateSwitchCondition();
+
         if(Debug) {
             llvm::outs() << "Current switch condition is: " << CurrentSwitchCondition.Dump()
                          << "\n";
@@ -183,6 +225,8 @@ public:
     {
         // TODO: this needs to detect if there is a loop inside this case statement or not
         CurrentSwitchCondition = Condition();
+        InCaseGroup = false;
+        Target.EndActionGroup();
 
         if(Debug) {
             llvm::outs() << "Hit case break\n";
@@ -192,28 +236,22 @@ public:
 
     bool VisitDefaultStmt(clang::DefaultStmt* stmt)
     {
-        // TODO: this only works correctly if the default statement is last
-
-        Condition defaultCondition;
-
-        for(const auto& cond : SwitchCases) {
-            if(defaultCondition.IsAlwaysTrue()) {
-                defaultCondition = cond.Negate();
-            } else {
-                defaultCondition = defaultCondition.And(cond.Negate());
-            }
+        // Default matches everything not in AllCases, if cases fall through to here their
+        // values also need to match
+        std::vector<ValueRange::SetValue> excluded;
+
+        for(const auto value : AllCases) {
+            if(!InCaseGroup || IsDefaultGroup ||
+                std::find(CurrentCases.begin(), CurrentCases.end(), value) ==
+                    CurrentCases.end())
+                excluded.push_back(value);
         }
 
-        if(defaultCondition.IsAlwaysTrue()) {
-            if(Debug)
-                llvm::outs() << "default condition is always true\n";
-        }
+        InCaseGroup = true;
+        IsDefaultGroup = true;
+        CurrentCases = std::move(excluded);
 
-        if(CurrentSwitchCondition.IsAlwaysTrue()) {
-            CurrentSwitchCondition = defaultCondition;
-        } else {
-            CurrentSwitchCondition = CurrentSwitchCondition.Or(defaultCondition);
-        }
+        UpdateSwitchCondition();
 
         if(Debug) {
             llvm::outs() << "Default switch case condition is: "
@@ -230,12 +268,85 @@ public:
         return BaseCondition.And(CurrentSwitchCondition);
     }
 
+protected:
+    //! Collects the case values without entering nested switches
+    class CaseValueCollector : public clang::RecursiveASTVisitor<CaseValueCollector> {
+    public:
+        CaseValueCollector(CaseConditionalVisitor& owner) : Owner(owner) {}
+
+        bool VisitCaseStmt(clang::CaseStmt* stmt)
+        {
+            const auto value = Owner.ParseCaseValue(stmt);
+
+            if(value)
+                Owner.AllCases.push_back(*value);
+
+            return true;
+        }
+
+        bool TraverseSwitchStmt(clang::SwitchStmt*)
+        {
+            return true;
+        }
+
+    private:
+        CaseConditionalVisitor& Owner;
+    };
+
+    std::optional<ValueRange::SetValue> ParseCaseValue(clang::CaseStmt* stmt)
+    {
+        if(!stmt->getLHS()) {
+            llvm::outs() << "Case statement without LHS";
+            return std::optional<ValueRange::SetValue>{};
+        }
+
+        LiteralStateVisitor literal;
+        literal.TraverseStmt(stmt->getLHS());
+
+        if(!literal.FoundValue ||
+            literal.FoundValue->State != VariableState::STATE::Primitive) {
+            if(Debug) {
+                llvm::outs() << "Could not parse switch case value: ";
+                stmt->getLHS()->dump();
+            }
+            return std::optional<ValueRange::SetValue>{};
+        }
+
+        auto value = literal.FoundValue->GetPrimitive();
+
+        // For example case -1 needs to match the largest value in an unsigned switch
+        if(ConditionType)
+            value = value.ConvertTo(*ConditionType);
+
+        return value.AsSignedWide();
+    }
+
+    void UpdateSwitchCondition()
+    {
+        const ValueRange range(IsDefaultGroup ? ValueRange::RANGE_CLASS::NotInSet :
+                                                ValueRange::RANGE_CLASS::InSet,
+            CurrentCases);
+
+        CurrentSwitchCondition =
+            SwitchConstant ? Condition(VariableStateCondition(*SwitchConstant, range)) :
+                             Condition(VariableValueCondition(SwitchVar, range));
+        Target.EndActionGroup();
+    }
+
 protected:
     Condition BaseCondition;
     Condition CurrentSwitchCondition;
-    std::vector<Condition> SwitchCases;
     VariableIdentifier SwitchVar;
     std::optional<VariableState> SwitchConstant;
+    std::optional<PRIMITIVE_TYPE> ConditionType;
+
+    //! All case values in this switch
+    std::vector<ValueRange::SetValue> AllCases;
+
+    //! Values of the current case group, or the excluded values if IsDefaultGroup
+    std::vector<ValueRange::SetValue> CurrentCases;
+    bool InCaseGroup = false;
+    bool IsDefaultGroup = false;
 };
 // ------------------------------------ //
 // CodeBlockBuildingVisitor::ValueVisitBase
@@ -260,13 +371,13 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::VisitVarDecl(clang::VarDecl* var)
 
     VariableState state;
 
-    const std::string varName = var->getQualifiedNameAsString();
-    const std::string varType = var->getType().getAsString();
+    const VariableIdentifier ident(var);
 
     const auto* value = var->getAnyInitializer();
 
     if(Debug)
-        llvm::outs() << "local var: " << varType << " " << varName << " init: ";
+        llvm::outs() << "local var: " << var->getType().getAsString() << " " << ident.Dump()
+                     << " init: ";
 
     if(value) {
 
@@ -277,8 +388,20 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::VisitVarDecl(clang::VarDecl* var)
                 llvm::outs() << "string literal('" << literal->getBytes() << "')";
             state.Set(BufferInfo(literal->getByteLength()));
         } else {
-            if(Debug)
-                llvm::outs() << "unknown initializer type";
+            const auto literal = ParseLiteralInitializer(value);
+            const auto type = PrimitiveTypeOf(var->getType(), Context);
+
+            if(literal && type) {
+
+                // The initializer is converted to the variable type like in C
+                state.Set(literal->ConvertTo(*type));
+
+                if(Debug)
+                    llvm::outs() << "literal(" << state.Dump() << ")";
+            } else {
+                if(Debug)
+                    llvm::outs() << "unknown initializer type";
+            }
         }
     } else {
         if(Debug)
@@ -295,9 +418,9 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::VisitVarDecl(clang::VarDecl* var)
     //     <<
     //     ":"
     //                  << fullLocation.getSpellingColumnNumber() << "\n";
-    Target.AddProcessedAction(std::make_unique<action::VarDeclared>(
-                                  GetCurrentCondition(), VariableIdentifier(var), state),
-        fullLocation);
+    Target.AddLocalVariable(ident);
+    Target.AddProcessedAction(
+        GetCurrentCondition(), action::VarDeclared{ident, state}, fullLocation);
 
     return true;
 }
@@ -323,16 +446,22 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::TraverseIfStmt(clang::IfStmt* stm
                      << GetCurrentCondition().And(condition).Dump() << "\n"
                      << "Negated: " << negated.Dump() << "\n";
 
+    // Each branch and the code after the if statement are separate action groups. The group
+    // after this re-evaluates the enclosing condition, see ActionGroup
+    Target.EndActionGroup();
+
     if(!negated.IsAlwaysTrue()) {
         ConditionalContentVisitor visitor(
             GetCurrentCondition().And(condition), Context, Target, Debug);
         visitor.TraverseStmt(stmt->getThen());
+        Target.EndActionGroup();
     }
 
     if(!condition.IsAlwaysTrue()) {
         ConditionalContentVisitor visitor(
             GetCurrentCondition().And(negated), Context, Target, Debug);
         visitor.TraverseStmt(stmt->getElse());
+        Target.EndActionGroup();
     }
 
     return true;
@@ -383,7 +512,15 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::TraverseSwitchStmt(clang::SwitchS
     CaseConditionalVisitor visitor =
         var ? CaseConditionalVisitor(GetCurrentCondition(), *var, Context, Target, Debug) :
               CaseConditionalVisitor(GetCurrentCondition(), *literal, Context, Target, Debug);
+
+    if(stmt->getCond())
+        visitor.SetConditionType(PrimitiveTypeOf(stmt->getCond()->getType(), Context));
+
+    visitor.CollectCaseValues(stmt->getBody());
+
+    Target.EndActionGroup();
     visitor.TraverseStmt(stmt->getBody());
+    Target.EndActionGroup();
 
     return true;
 }
@@ -414,8 +551,11 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::VisitArraySubscriptExpr(
         if(Debug)
             llvm::outs() << "used array index: " << literal->getValue() << "\n";
 
-        // TODO: this can only handle 64 bit numbers, anything higher will cause an error
-        indexValue.Set(PrimitiveInfo(literal->getValue().getSExtValue()));
+        const auto primitive = PrimitiveInfo::FromAPInt(
+            literal->getValue(), literal->getType()->isSignedIntegerType());
+
+        if(primitive)
+            indexValue.Set(*primitive);
 
     } else {
         if(Debug)
@@ -423,8 +563,8 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::VisitArraySubscriptExpr(
     }
 
     if(indexValue.State != VariableState::STATE::Unknown) {
-        Target.AddProcessedAction(std::make_unique<action::ArrayIndexAccess>(
-                                      GetCurrentCondition(), *lhsVisitor.FoundVar, indexValue),
+        Target.AddProcessedAction(GetCurrentCondition(),
+            action::ArrayIndexAccess{*lhsVisitor.FoundVar, indexValue},
             Context.getFullLoc(expr->getBeginLoc()));
     }
 
@@ -467,8 +607,8 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::VisitBinaryOperator(clang::Binary
 
         // TODO: the location here is not fully accurate, the sub visitor needs to store the
         // accurate location
-        Target.AddProcessedAction(std::make_unique<action::VarAssigned>(GetCurrentCondition(),
-                                      *lhsVisitor.FoundVar, *rhsVisitor.ParsedState),
+        Target.AddProcessedAction(GetCurrentCondition(),
+            action::VarAssigned{*lhsVisitor.FoundVar, *rhsVisitor.ParsedState},
             Context.getFullLoc(op->getBeginLoc()));
     }
     return true;
@@ -502,8 +642,7 @@ bool CodeBlockBuildingVisitor::ValueVisitBase::TraverseCallExpr(clang::CallExpr*
         }
     }
 
-    Target.AddProcessedAction(std::make_unique<action::FunctionCall>(
-                                  GetCurrentCondition(), functionName, callParams),
+    Target.AddFunctionCall(GetCurrentCondition(), functionName, callParams,
         Context.getFullLoc(call->getBeginLoc()));
 
     return true;
@@ -1,6 +1,8 @@
 // ------------------------------------ //
 #include "Condition.h"
 
+#include "ConditionArena.h"
+#include "ConditionCompiler.h"
 #include "LiteralStateVisitor.h"
 
 #include "clang/AST/RecursiveASTVisitor.h"
@@ -72,11 +74,11 @@ public:
             }
 
             if(rhsVisitor.Variable) {
-                Parts = Condition::Part(VariableValueCondition(
+                Parts = Condition(VariableValueCondition(
                     *lhsVisitor.Variable, ValueRange(*translatedOp, *rhsVisitor.Variable)));
             } else {
 
-                Parts = Condition::Part(VariableValueCondition(
+                Parts = Condition(VariableValueCondition(
                     *lhsVisitor.Variable, ValueRange(*translatedOp, *rhsConstant)));
             }
             return false;
@@ -105,7 +107,7 @@ public:
                 return false;
             }
 
-            Parts = Condition::Part(VariableValueCondition(
+            Parts = Condition(VariableValueCondition(
                 *subVisitor.Variable, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
             return false;
         }
@@ -139,13 +141,13 @@ public:
     void CheckIfOnlyVariable()
     {
         if(!Parts && Variable) {
-            Parts = Condition::Part(VariableValueCondition(
+            Parts = Condition(VariableValueCondition(
                 *Variable, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
         }
     }
 
     std::optional<VariableIdentifier> Variable;
-    std::optional<Condition::Part> Parts;
+    std::optional<Condition> Parts;
 };
 // ------------------------------------ //
 // VariableValueCondition
@@ -170,178 +172,65 @@ std::string VariableStateCondition::Dump() const
     return State.Dump() + " " + Value.Dump();
 }
 
-// ------------------------------------ //
-// Condition::Part
-bool Condition::Part::Evaluate(const VariableValueProvider& values) const
-{
-    if(auto value = std::get_if<VariableValueCondition>(&Value); value) {
-
-        const auto actualValue = values.GetVariableValue(value->Variable);
-
-        // TODO: somehow pass that this is unknown to the top level (maybe an exception?)
-        if(actualValue.State == VariableState::STATE::Unknown) {
-            return false;
-        }
-
-        return value->Value.Matches(actualValue, values);
-
-    } else if(auto value = std::get_if<VariableStateCondition>(&Value); value) {
-
-        const auto actualValue = value->State.Resolve(values);
-
-        // TODO: somehow pass that this is unknown to the top level (maybe an exception?)
-        if(actualValue.State == VariableState::STATE::Unknown) {
-            return false;
-        }
-
-        return value->Value.Matches(actualValue, values);
-
-    } else if(auto combined = std::get_if<CombinedParts>(&Value); combined) {
-
-        switch(std::get<1>(*combined)) {
-        case COMBINE_OPERATOR::And:
-            if(std::get<0>(*combined)->Evaluate(values) &&
-                std::get<2>(*combined)->Evaluate(values))
-                return true;
-            return false;
-        case COMBINE_OPERATOR::Or:
-            if(std::get<0>(*combined)->Evaluate(values) ||
-                std::get<2>(*combined)->Evaluate(values))
-                return true;
-            return false;
-        }
-
-        throw std::runtime_error("unimplemented combine operator in Evaluate");
-
-    } else {
-        throw std::runtime_error("evaluate not implemented for this variant type");
-    }
-}
-// ------------------------------------ //
-Condition::Part Condition::Part::Negate() const
-{
-    if(auto value = std::get_if<VariableValueCondition>(&Value); value) {
-
-        return Part(value->Negate());
-
-    } else if(auto value = std::get_if<VariableStateCondition>(&Value); value) {
-
-        return Part(value->Negate());
-
-    } else if(auto combined = std::get_if<CombinedParts>(&Value); value) {
-        return Part(std::make_shared<Part>(std::get<0>(*combined)->Negate()),
-            NegateCombineOperator(std::get<1>(*combined)),
-            std::make_shared<Part>(std::get<2>(*combined)->Negate()));
-    } else {
-        throw std::runtime_error("negate not implemented for this variant type");
-    }
-}
-
-std::string Condition::Part::Dump() const
-{
-    if(auto value = std::get_if<VariableValueCondition>(&Value); value) {
-
-        return value->Dump();
-
-    } else if(auto value = std::get_if<VariableStateCondition>(&Value); value) {
-
-        return value->Dump();
-
-    } else if(auto combined = std::get_if<CombinedParts>(&Value); combined) {
-
-        std::stringstream sstream;
-        sstream << "(";
-
-        sstream << std::get<0>(*combined)->Dump() << ") "
-                << CombineOperatorToString(std::get<1>(*combined)) << " (";
-
-        sstream << std::get<2>(*combined)->Dump() << ")";
-        return sstream.str();
-    } else {
-        return "invalid";
-    }
-}
 // ------------------------------------ //
 // Condition
-Condition::Condition(clang::Stmt* stmt)
+Condition::Condition(clang::Stmt* stmt) : Node(TRUE_NODE)
 {
     ConditionParseVisitor visitor;
     visitor.TraverseStmt(stmt);
     visitor.CheckIfOnlyVariable();
 
-    if(!visitor.Parts || visitor.Parts->DetectTautology()) {
-
-        Tautology = true;
-    } else {
-
-        VariableConditions = std::move(visitor.Parts);
-    }
+    if(visitor.Parts)
+        Node = visitor.Parts->Node;
 }
 
-Condition::Condition(const Part& part)
-{
-    if(part.DetectTautology()) {
-        Tautology = true;
-    } else {
+Condition::Condition(const VariableValueCondition& leaf) :
+    Node(ConditionArena::Get().AddLeaf(leaf))
+{}
 
-        VariableConditions = part;
-    }
-}
+Condition::Condition(const VariableStateCondition& leaf) :
+    Node(ConditionArena::Get().AddLeaf(leaf))
+{}
 // ------------------------------------ //
-bool Condition::Evaluate(const VariableValueProvider& values) const
+TRI_STATE Condition::Evaluate(const VariableValueProvider& values) const
 {
     if(IsAlwaysTrue())
-        return true;
+        return TRI_STATE::True;
 
-    return VariableConditions->Evaluate(values);
+    const auto& compiler = ConditionCompiler::Get();
+
+    if(compiler.IsCompiled(*this))
+        return compiler.Evaluate(*this, values);
+
+    return ConditionArena::Get().Evaluate(Node, values);
 }
 // ------------------------------------ //
 Condition Condition::Negate() const
 {
-    if(Tautology) {
-        Condition opposite;
-        opposite.SetTautology(false);
-        return opposite;
-    }
-
-    return Condition(VariableConditions->Negate());
+    return Condition(ConditionArena::Get().Not(Node));
 }
 
 Condition Condition::And(const Condition& other) const
 {
-    if(other.Tautology) {
-        Condition combined;
-        combined.SetTautology(true);
-        return combined;
-    }
-
-    if(Tautology) {
-        return Condition(*other.VariableConditions);
-    }
-
-    return Condition(Part(std::make_shared<Part>(*VariableConditions), COMBINE_OPERATOR::And,
-        std::make_shared<Part>(*other.VariableConditions)));
+    return Condition(ConditionArena::Get().And(Node, other.Node));
 }
 
 Condition Condition::Or(const Condition& other) const
 {
-    if(Tautology || other.Tautology) {
-        Condition combined;
-        combined.SetTautology(true);
-        return combined;
-    }
+    return Condition(ConditionArena::Get().Or(Node, other.Node));
+}
+
+void Condition::CollectVariables(std::vector<VariableIdentifier>& variables) const
+{
+    ConditionArena::Get().CollectVariables(Node, variables);
+}
 
-    return Condition(Part(std::make_shared<Part>(*VariableConditions), COMBINE_OPERATOR::Or,
-        std::make_shared<Part>(*other.VariableConditions)));
+bool Condition::IsNegationOf(const Condition& other) const
+{
+    return ConditionArena::Get().IsNegation(Node, other.Node);
 }
 // ------------------------------------ //
 std::string Condition::Dump() const
 {
-    if(Tautology)
-        return "tautology";
-
-    if(!VariableConditions)
-        return "invalid";
-
-    return VariableConditions->Dump();
+    return ConditionArena::Get().Dump(Node);
 }
@@ -4,9 +4,8 @@
 
 #include <clang/AST/Stmt.h>
 
-#include <memory>
-#include <unordered_map>
-#include <variant>
+#include <cstdint>
+#include <string>
 
 namespace smacpp {
 
@@ -24,6 +23,11 @@ public:
 
     std::string Dump() const;
 
+    bool operator==(const VariableValueCondition& other) const
+    {
+        return Variable == other.Variable && Value == other.Value;
+    }
+
     VariableIdentifier Variable;
     ValueRange Value;
 };
@@ -37,6 +41,11 @@ public:
 
     std::string Dump() const;
 
+    bool operator==(const VariableStateCondition& other) const
+    {
+        return State == other.State && Value == other.Value;
+    }
+
     VariableState State;
     ValueRange Value;
 };
@@ -71,52 +80,40 @@ inline COMBINE_OPERATOR NegateCombineOperator(COMBINE_OPERATOR op)
     return COMBINE_OPERATOR::And;
 }
 
-//! A parsed condition type
+//! \brief A parsed condition type
+//!
+//! This is a small handle to a node in the ConditionArena. Nodes are hash-consed so combining
+//! conditions with And, Or and Negate creates at most one new node and shares the operands
 class Condition {
 public:
-    struct Part {
-        using CombinedParts =
-            std::tuple<std::shared_ptr<Part>, COMBINE_OPERATOR, std::shared_ptr<Part>>;
-
-        Part(VariableValueCondition value) : Value(value) {}
-        Part(VariableStateCondition value) : Value(value) {}
-
-        Part(std::shared_ptr<Part> lhs, COMBINE_OPERATOR op, std::shared_ptr<Part> rhs) :
-            Value(std::make_tuple(lhs, op, rhs))
-        {}
-
-        bool Evaluate(const VariableValueProvider& values) const;
-
-        //! \brief Tries to detect if this is always true
-        //! \todo implement
-        bool DetectTautology() const
-        {
-            return false;
-        }
-
-        Part Negate() const;
-
-        std::string Dump() const;
-
-        //! shared_ptrs are used here to make copying work
-        std::variant<VariableValueCondition, VariableStateCondition, CombinedParts> Value;
-    };
-
+    using NodeID = uint32_t;
 
+    //! Reserved node ids
+    static constexpr NodeID TRUE_NODE = 0;
+    static constexpr NodeID FALSE_NODE = 1;
 
 public:
     //! Creates an always true condition
-    Condition() : Tautology(true) {}
+    Condition() : Node(TRUE_NODE) {}
+
+    explicit Condition(NodeID node) : Node(node) {}
 
     Condition(clang::Stmt* stmt);
 
-    Condition(const Part& part);
+    Condition(const VariableValueCondition& leaf);
+    Condition(const VariableStateCondition& leaf);
 
-    bool Evaluate(const VariableValueProvider& values) const;
+    //! \returns Unknown if the result depends on variables whose values aren't known
+    TRI_STATE Evaluate(const VariableValueProvider& values) const;
 
     bool IsAlwaysTrue() const
     {
-        return Tautology;
+        return Node == TRUE_NODE;
+    }
+
+    bool IsAlwaysFalse() const
+    {
+        return Node == FALSE_NODE;
     }
 
     Condition Negate() const;
@@ -124,18 +121,58 @@ public:
     Condition And(const Condition& other) const;
     Condition Or(const Condition& other) const;
 
-    void SetTautology(bool value)
+    NodeID GetNodeID() const
     {
-        Tautology = value;
+        return Node;
     }
 
+    //! \brief Adds the variables evaluating this reads to variables
+    void CollectVariables(std::vector<VariableIdentifier>& variables) const;
+
+    //! \returns True if this is the negation of other, doesn't add conditions unlike Negate
+    bool IsNegationOf(const Condition& other) const;
+
     std::string Dump() const;
 
-private:
-    //! \todo Add contradiction
-    bool Tautology = false;
+    bool operator==(const Condition& other) const
+    {
+        return Node == other.Node;
+    }
+
+    bool operator!=(const Condition& other) const
+    {
+        return Node != other.Node;
+    }
 
-    //! When not a tautology the parts are stored here
-    std::optional<Part> VariableConditions;
+private:
+    NodeID Node;
 };
 } // namespace smacpp
+
+namespace std {
+
+template<>
+struct hash<smacpp::VariableValueCondition> {
+    std::size_t operator()(const smacpp::VariableValueCondition& k) const
+    {
+        return smacpp::CombineHash(smacpp::MixHash(k.Variable.ID), k.Value.Hash());
+    }
+};
+
+template<>
+struct hash<smacpp::VariableStateCondition> {
+    std::size_t operator()(const smacpp::VariableStateCondition& k) const
+    {
+        return smacpp::CombineHash(k.State.Hash(), k.Value.Hash());
+    }
+};
+
+template<>
+struct hash<smacpp::Condition> {
+    std::size_t operator()(const smacpp::Condition& k) const
+    {
+        return hash<smacpp::Condition::NodeID>()(k.GetNodeID());
+    }
+};
+
+} // namespace std
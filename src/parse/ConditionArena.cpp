@@ -0,0 +1,273 @@
+// ------------------------------------ //
+#include "ConditionArena.h"
+
+#include <sstream>
+
+using namespace smacpp;
+// ------------------------------------ //
+ConditionArena::ConditionArena()
+{
+    Clear();
+}
+
+ConditionArena& ConditionArena::Get()
+{
+    static ConditionArena arena;
+    return arena;
+}
+// ------------------------------------ //
+ConditionArena::NodeID ConditionArena::Intern(const Node& node)
+{
+    const auto found = ExistingNodes.find(node);
+
+    if(found != ExistingNodes.end())
+        return found->second;
+
+    const auto id = static_cast<NodeID>(Nodes.size());
+    Nodes.push_back(node);
+    ExistingNodes[node] = id;
+    return id;
+}
+// ------------------------------------ //
+ConditionArena::NodeID ConditionArena::AddLeaf(const VariableValueCondition& leaf)
+{
+    auto found = ExistingValueLeaves.find(leaf);
+
+    if(found == ExistingValueLeaves.end()) {
+        found = ExistingValueLeaves.emplace(leaf, static_cast<uint32_t>(ValueLeaves.size()))
+                    .first;
+        ValueLeaves.push_back(leaf);
+    }
+
+    return Intern(Node{Node::KIND::Value, found->second});
+}
+
+ConditionArena::NodeID ConditionArena::AddLeaf(const VariableStateCondition& leaf)
+{
+    auto found = ExistingStateLeaves.find(leaf);
+
+    if(found == ExistingStateLeaves.end()) {
+        found = ExistingStateLeaves.emplace(leaf, static_cast<uint32_t>(StateLeaves.size()))
+                    .first;
+        StateLeaves.push_back(leaf);
+    }
+
+    return Intern(Node{Node::KIND::State, found->second});
+}
+// ------------------------------------ //
+ConditionArena::NodeID ConditionArena::And(NodeID lhs, NodeID rhs)
+{
+    if(lhs == Condition::TRUE_NODE || lhs == rhs)
+        return rhs;
+
+    if(rhs == Condition::TRUE_NODE)
+        return lhs;
+
+    if(lhs == Condition::FALSE_NODE || rhs == Condition::FALSE_NODE)
+        return Condition::FALSE_NODE;
+
+    return Intern(Node{Node::KIND::And, lhs, rhs});
+}
+
+ConditionArena::NodeID ConditionArena::Or(NodeID lhs, NodeID rhs)
+{
+    if(lhs == Condition::TRUE_NODE || rhs == Condition::TRUE_NODE)
+        return Condition::TRUE_NODE;
+
+    if(lhs == Condition::FALSE_NODE || lhs == rhs)
+        return rhs;
+
+    if(rhs == Condition::FALSE_NODE)
+        return lhs;
+
+    return Intern(Node{Node::KIND::Or, lhs, rhs});
+}
+
+ConditionArena::NodeID ConditionArena::Not(NodeID node)
+{
+    const Node& target = Nodes[node];
+
+    switch(target.Kind) {
+    case Node::KIND::True: return Condition::FALSE_NODE;
+    case Node::KIND::False: return Condition::TRUE_NODE;
+    // Negated leaves are still leaves so that unknown values make both the leaf and its
+    // negation false
+    case Node::KIND::Value: return AddLeaf(ValueLeaves[target.First].Negate());
+    case Node::KIND::State: return AddLeaf(StateLeaves[target.First].Negate());
+    case Node::KIND::Not: return target.First;
+    case Node::KIND::And:
+    case Node::KIND::Or: return Intern(Node{Node::KIND::Not, node});
+    }
+
+    throw std::runtime_error("unhandled node kind in ConditionArena::Not");
+}
+// ------------------------------------ //
+TRI_STATE ConditionArena::Evaluate(NodeID id, const VariableValueProvider& values) const
+{
+    const Node& node = Nodes[id];
+
+    switch(node.Kind) {
+    case Node::KIND::True: return TRI_STATE::True;
+    case Node::KIND::False: return TRI_STATE::False;
+    case Node::KIND::Value: return EvaluateValueLeaf(node.First, values);
+    case Node::KIND::State: return EvaluateStateLeaf(node.First, values);
+    case Node::KIND::And: {
+        const auto lhs = Evaluate(node.First, values);
+
+        if(lhs == TRI_STATE::False)
+            return lhs;
+
+        return KleeneAnd(lhs, Evaluate(node.Second, values));
+    }
+    case Node::KIND::Or: {
+        const auto lhs = Evaluate(node.First, values);
+
+        if(lhs == TRI_STATE::True)
+            return lhs;
+
+        return KleeneOr(lhs, Evaluate(node.Second, values));
+    }
+    case Node::KIND::Not: return KleeneNot(Evaluate(node.First, values));
+    }
+
+    throw std::runtime_error("unhandled node kind in ConditionArena::Evaluate");
+}
+
+TRI_STATE ConditionArena::EvaluateValueLeaf(
+    uint32_t index, const VariableValueProvider& values) const
+{
+    const auto& leaf = ValueLeaves[index];
+
+    return leaf.Value.Matches(values.GetVariableValue(leaf.Variable), values);
+}
+
+TRI_STATE ConditionArena::EvaluateStateLeaf(
+    uint32_t index, const VariableValueProvider& values) const
+{
+    const auto& leaf = StateLeaves[index];
+
+    return leaf.Value.Matches(leaf.State.Resolve(values), values);
+}
+// ------------------------------------ //
+void ConditionArena::CollectVariables(
+    NodeID id, std::vector<VariableIdentifier>& variables) const
+{
+    const Node& node = Nodes[id];
+
+    switch(node.Kind) {
+    case Node::KIND::True:
+    case Node::KIND::False: return;
+    case Node::KIND::Value: {
+        const auto& leaf = ValueLeaves[node.First];
+        variables.push_back(leaf.Variable);
+        leaf.Value.CollectVariables(variables);
+        return;
+    }
+    case Node::KIND::State: {
+        const auto& leaf = StateLeaves[node.First];
+        leaf.State.CollectVariables(variables);
+        leaf.Value.CollectVariables(variables);
+        return;
+    }
+    case Node::KIND::And:
+    case Node::KIND::Or:
+        CollectVariables(node.First, variables);
+        CollectVariables(node.Second, variables);
+        return;
+    case Node::KIND::Not: CollectVariables(node.First, variables); return;
+    }
+}
+// ------------------------------------ //
+bool ConditionArena::IsNegation(NodeID lhs, NodeID rhs) const
+{
+    const Node& first = Nodes[lhs];
+    const Node& second = Nodes[rhs];
+
+    if(first.Kind == Node::KIND::Not && first.First == rhs)
+        return true;
+
+    if(second.Kind == Node::KIND::Not && second.First == lhs)
+        return true;
+
+    if(first.Kind != second.Kind)
+        return (first.Kind == Node::KIND::True && second.Kind == Node::KIND::False) ||
+               (first.Kind == Node::KIND::False && second.Kind == Node::KIND::True);
+
+    switch(first.Kind) {
+    case Node::KIND::Value:
+        return ValueLeaves[first.First].Negate() == ValueLeaves[second.First];
+    case Node::KIND::State:
+        return StateLeaves[first.First].Negate() == StateLeaves[second.First];
+    default: return false;
+    }
+}
+
+void ConditionArena::CollectImpliedRanges(NodeID id, bool assumed,
+    std::vector<std::tuple<VariableIdentifier, ValueRange>>& ranges) const
+{
+    const Node& node = Nodes[id];
+
+    switch(node.Kind) {
+    case Node::KIND::True:
+    case Node::KIND::False:
+    case Node::KIND::State: return;
+    case Node::KIND::Value: {
+        const auto& leaf = ValueLeaves[node.First];
+        ranges.emplace_back(leaf.Variable, assumed ? leaf.Value : leaf.Value.Negate());
+        return;
+    }
+    // Only a true and or a false or tells something about both operands
+    case Node::KIND::And:
+        if(assumed) {
+            CollectImpliedRanges(node.First, true, ranges);
+            CollectImpliedRanges(node.Second, true, ranges);
+        }
+        return;
+    case Node::KIND::Or:
+        if(!assumed) {
+            CollectImpliedRanges(node.First, false, ranges);
+            CollectImpliedRanges(node.Second, false, ranges);
+        }
+        return;
+    case Node::KIND::Not: CollectImpliedRanges(node.First, !assumed, ranges); return;
+    }
+}
+// ------------------------------------ //
+std::string ConditionArena::Dump(NodeID id) const
+{
+    const Node& node = Nodes[id];
+
+    switch(node.Kind) {
+    case Node::KIND::True: return "tautology";
+    case Node::KIND::False: return "contradiction";
+    case Node::KIND::Value: return ValueLeaves[node.First].Dump();
+    case Node::KIND::State: return StateLeaves[node.First].Dump();
+    case Node::KIND::And:
+    case Node::KIND::Or: {
+        std::stringstream sstream;
+        sstream << "(" << Dump(node.First) << ") "
+                << CombineOperatorToString(node.Kind == Node::KIND::And ?
+                                               COMBINE_OPERATOR::And :
+                                               COMBINE_OPERATOR::Or)
+                << " (" << Dump(node.Second) << ")";
+        return sstream.str();
+    }
+    case Node::KIND::Not: return "not (" + Dump(node.First) + ")";
+    }
+
+    return "invalid";
+}
+// ------------------------------------ //
+void ConditionArena::Clear()
+{
+    Nodes.clear();
+    ExistingNodes.clear();
+    ValueLeaves.clear();
+    ExistingValueLeaves.clear();
+    StateLeaves.clear();
+    ExistingStateLeaves.clear();
+
+    // The always true and false nodes need to have the reserved ids
+    Intern(Node{Node::KIND::True});
+    Intern(Node{Node::KIND::False});
+}
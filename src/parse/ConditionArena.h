@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Condition.h"
+
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace smacpp {
+
+//! \brief Hash-consed DAG that all Condition handles point into
+//!
+//! Each unique leaf and each unique (kind, lhs, rhs) node is only stored once, so equal
+//! conditions have equal ids and deeply nested conditions share their common parts. Like
+//! SymbolTable this holds the conditions of a single analysis run
+class ConditionArena {
+public:
+    using NodeID = Condition::NodeID;
+
+    struct Node {
+        enum class KIND : uint8_t { True, False, Value, State, And, Or, Not };
+
+        bool operator==(const Node& other) const
+        {
+            return Kind == other.Kind && First == other.First && Second == other.Second;
+        }
+
+        KIND Kind;
+
+        //! Leaf index for Value and State, operand nodes for the combining kinds
+        uint32_t First = 0;
+        uint32_t Second = 0;
+    };
+
+    struct NodeHash {
+        std::size_t operator()(const Node& node) const
+        {
+            return CombineHash(MixHash(static_cast<uint64_t>(node.Kind) |
+                                       (static_cast<uint64_t>(node.First) << 8)),
+                MixHash(node.Second));
+        }
+    };
+
+public:
+    ConditionArena();
+
+    //! \returns The arena used by the current run
+    static ConditionArena& Get();
+
+    NodeID AddLeaf(const VariableValueCondition& leaf);
+    NodeID AddLeaf(const VariableStateCondition& leaf);
+
+    //! \brief These simplify when an operand is always true or false
+    NodeID And(NodeID lhs, NodeID rhs);
+    NodeID Or(NodeID lhs, NodeID rhs);
+
+    //! \brief Leaves are negated by negating their range, other nodes get a Not node
+    NodeID Not(NodeID node);
+
+    const Node& GetNode(NodeID id) const
+    {
+        return Nodes[id];
+    }
+
+    const VariableValueCondition& GetValueLeaf(uint32_t index) const
+    {
+        return ValueLeaves[index];
+    }
+
+    const VariableStateCondition& GetStateLeaf(uint32_t index) const
+    {
+        return StateLeaves[index];
+    }
+
+    size_t GetNodeCount() const
+    {
+        return Nodes.size();
+    }
+
+    //! \brief Recursively evaluates a node with Kleene logic, ConditionCompiler is used for
+    //! the fast path
+    TRI_STATE Evaluate(NodeID id, const VariableValueProvider& values) const;
+
+    TRI_STATE EvaluateValueLeaf(uint32_t index, const VariableValueProvider& values) const;
+    TRI_STATE EvaluateStateLeaf(uint32_t index, const VariableValueProvider& values) const;
+
+    //! \brief Adds the variables the leaves under a node read to variables
+    void CollectVariables(NodeID id, std::vector<VariableIdentifier>& variables) const;
+
+    //! \returns True if lhs is the negation of rhs
+    //! \note Unlike Not this doesn't add nodes, so this can be used while analysing
+    bool IsNegation(NodeID lhs, NodeID rhs) const;
+
+    //! \brief Adds the ranges that the node being assumed implies for variables to ranges
+    //!
+    //! For example assuming "x < 5" false implies that x is in the range ">= 5"
+    void CollectImpliedRanges(NodeID id, bool assumed,
+        std::vector<std::tuple<VariableIdentifier, ValueRange>>& ranges) const;
+
+    std::string Dump(NodeID id) const;
+
+    //! \brief Forgets all conditions, needs to be called before starting a new run
+    void Clear();
+
+private:
+    NodeID Intern(const Node& node);
+
+private:
+    //! Indexed by NodeID
+    std::vector<Node> Nodes;
+    std::unordered_map<Node, NodeID, NodeHash> ExistingNodes;
+
+    std::vector<VariableValueCondition> ValueLeaves;
+    std::unordered_map<VariableValueCondition, uint32_t> ExistingValueLeaves;
+
+    std::vector<VariableStateCondition> StateLeaves;
+    std::unordered_map<VariableStateCondition, uint32_t> ExistingStateLeaves;
+};
+
+} // namespace smacpp
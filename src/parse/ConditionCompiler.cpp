@@ -0,0 +1,180 @@
+// ------------------------------------ //
+#include "ConditionCompiler.h"
+
+#include <sstream>
+
+using namespace smacpp;
+using OPCODE = ConditionInstruction::OPCODE;
+// ------------------------------------ //
+ConditionCompiler& ConditionCompiler::Get()
+{
+    static ConditionCompiler compiler;
+    return compiler;
+}
+// ------------------------------------ //
+void ConditionCompiler::Compile(Condition condition)
+{
+    if(IsCompiled(condition))
+        return;
+
+    const auto& arena = ConditionArena::Get();
+
+    if(ProgramStarts.size() < arena.GetNodeCount())
+        ProgramStarts.resize(arena.GetNodeCount(), NOT_COMPILED);
+
+    const auto start = static_cast<uint32_t>(Code.size());
+
+    Emit(condition.GetNodeID(), arena, false);
+    Code.push_back(ConditionInstruction{OPCODE::Return});
+
+    ProgramStarts[condition.GetNodeID()] = start;
+}
+
+void ConditionCompiler::Emit(
+    Condition::NodeID node, const ConditionArena& arena, bool inverted)
+{
+    using KIND = ConditionArena::Node::KIND;
+
+    const auto& current = arena.GetNode(node);
+
+    switch(current.Kind) {
+    case KIND::True: Code.push_back(ConditionInstruction{OPCODE::True}); return;
+    case KIND::False: Code.push_back(ConditionInstruction{OPCODE::False}); return;
+    case KIND::Value:
+        Code.push_back(ConditionInstruction{OPCODE::ValueLeaf, inverted, current.First});
+        return;
+    case KIND::State:
+        Code.push_back(ConditionInstruction{OPCODE::StateLeaf, inverted, current.First});
+        return;
+    case KIND::Not:
+        Emit(current.First, arena, !inverted);
+        Code.push_back(ConditionInstruction{OPCODE::Not});
+        return;
+    case KIND::And:
+    case KIND::Or: {
+        // The rhs is only evaluated if the lhs doesn't already decide the result, in which
+        // case the rhs result is the result of the whole node
+        Emit(current.First, arena, inverted);
+
+        const auto jump = Code.size();
+        Code.push_back(ConditionInstruction{
+            current.Kind == KIND::And ? OPCODE::JumpIfFalse : OPCODE::JumpIfTrue});
+
+        Emit(current.Second, arena, inverted);
+
+        Code[jump].Operand = static_cast<uint32_t>(Code.size() - jump);
+        return;
+    }
+    }
+
+    throw std::runtime_error("unhandled node kind in ConditionCompiler");
+}
+// ------------------------------------ //
+TRI_STATE ConditionCompiler::Evaluate(
+    Condition condition, const VariableValueProvider& values) const
+{
+    const auto start = ProgramStarts[condition.GetNodeID()];
+
+    bool sawUnknown = false;
+    const bool pessimistic = Run(start, values, false, sawUnknown);
+
+    if(!sawUnknown)
+        return ToTriState(pessimistic);
+
+    if(pessimistic)
+        return TRI_STATE::True;
+
+    return Run(start, values, true, sawUnknown) ? TRI_STATE::Unknown : TRI_STATE::False;
+}
+
+bool ConditionCompiler::Run(uint32_t start, const VariableValueProvider& values,
+    bool unknownMatches, bool& sawUnknown) const
+{
+    const auto& arena = ConditionArena::Get();
+
+    const ConditionInstruction* instruction = Code.data() + start;
+    bool result = false;
+
+    TRI_STATE leaf;
+
+    while(true) {
+        switch(instruction->Op) {
+        case OPCODE::True: result = true; break;
+        case OPCODE::False: result = false; break;
+        case OPCODE::ValueLeaf:
+        case OPCODE::StateLeaf:
+            leaf = instruction->Op == OPCODE::ValueLeaf ?
+                       arena.EvaluateValueLeaf(instruction->Operand, values) :
+                       arena.EvaluateStateLeaf(instruction->Operand, values);
+
+            if(leaf == TRI_STATE::Unknown) {
+                sawUnknown = true;
+                result = unknownMatches != instruction->Inverted;
+            } else {
+                result = leaf == TRI_STATE::True;
+            }
+            break;
+        case OPCODE::Not: result = !result; break;
+        case OPCODE::JumpIfFalse:
+            if(!result) {
+                instruction += instruction->Operand;
+                continue;
+            }
+            break;
+        case OPCODE::JumpIfTrue:
+            if(result) {
+                instruction += instruction->Operand;
+                continue;
+            }
+            break;
+        case OPCODE::Return: return result;
+        }
+
+        ++instruction;
+    }
+}
+// ------------------------------------ //
+std::string ConditionCompiler::Dump(Condition condition) const
+{
+    if(!IsCompiled(condition))
+        return "not compiled";
+
+    const auto& arena = ConditionArena::Get();
+
+    std::stringstream sstream;
+
+    for(auto i = ProgramStarts[condition.GetNodeID()]; i < Code.size(); ++i) {
+        const auto& instruction = Code[i];
+
+        sstream << i << ": ";
+
+        switch(instruction.Op) {
+        case OPCODE::True: sstream << "true"; break;
+        case OPCODE::False: sstream << "false"; break;
+        case OPCODE::ValueLeaf:
+            sstream << "leaf " << arena.GetValueLeaf(instruction.Operand).Dump();
+            break;
+        case OPCODE::StateLeaf:
+            sstream << "leaf " << arena.GetStateLeaf(instruction.Operand).Dump();
+            break;
+        case OPCODE::Not: sstream << "not"; break;
+        case OPCODE::JumpIfFalse:
+            sstream << "jump if false to " << (i + instruction.Operand);
+            break;
+        case OPCODE::JumpIfTrue:
+            sstream << "jump if true to " << (i + instruction.Operand);
+            break;
+        case OPCODE::Return: sstream << "return\n"; return sstream.str();
+        }
+
+        sstream << "\n";
+    }
+
+    return sstream.str();
+}
+// ------------------------------------ //
+void ConditionCompiler::Clear()
+{
+    Code.clear();
+    ProgramStarts.clear();
+}
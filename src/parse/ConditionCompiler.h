@@ -0,0 +1,91 @@
+#pragma once
+
+#include "ConditionArena.h"
+
+#include <vector>
+
+namespace smacpp {
+
+//! \brief Single instruction of compiled condition bytecode
+struct ConditionInstruction {
+    enum class OPCODE : uint8_t {
+        //! Sets the result register
+        True,
+        False,
+        //! Evaluates the leaf with index Operand into the result register
+        ValueLeaf,
+        StateLeaf,
+        Not,
+        //! Skips Operand instructions forward if the result register matches, these implement
+        //! the short-circuiting of and / or
+        JumpIfFalse,
+        JumpIfTrue,
+        Return
+    };
+
+    OPCODE Op;
+
+    //! Set for leaves under an odd number of Not instructions
+    bool Inverted = false;
+    uint32_t Operand = 0;
+};
+
+//! \brief Lowers conditions from the ConditionArena into flat postfix bytecode
+//!
+//! All compiled code is in one contiguous buffer. The interpreter doesn't recurse or
+//! allocate, which matters as conditions are evaluated once per action per analysis
+//! operation. Compiling is done while building CodeBlocks so that evaluation only reads.
+//!
+//! The interpreter works on a single bool register. Kleene logic is implemented by running
+//! the code a second time if a leaf was unknown: first with the unknown leaves set so that
+//! they make the whole condition false and then so that they make it true. If the results
+//! differ the result is unknown
+class ConditionCompiler {
+public:
+    static constexpr uint32_t NOT_COMPILED = UINT32_MAX;
+
+public:
+    //! \returns The compiler used by the current run
+    static ConditionCompiler& Get();
+
+    //! \brief Compiles a condition if it isn't already
+    void Compile(Condition condition);
+
+    bool IsCompiled(Condition condition) const
+    {
+        return condition.GetNodeID() < ProgramStarts.size() &&
+               ProgramStarts[condition.GetNodeID()] != NOT_COMPILED;
+    }
+
+    //! \brief Runs the compiled code of a condition
+    //! \pre IsCompiled(condition)
+    TRI_STATE Evaluate(Condition condition, const VariableValueProvider& values) const;
+
+    std::string Dump(Condition condition) const;
+
+    size_t GetCodeSize() const
+    {
+        return Code.size();
+    }
+
+    //! \brief Forgets all compiled code, needs to be called before starting a new run
+    void Clear();
+
+private:
+    //! \param inverted True if the node is under an odd number of Not nodes
+    void Emit(Condition::NodeID node, const ConditionArena& arena, bool inverted);
+
+    //! \brief Runs code starting from start
+    //! \param unknownMatches Value unknown leaves that aren't inverted get
+    //! \param sawUnknown Set to true if an unknown leaf was found
+    bool Run(uint32_t start, const VariableValueProvider& values, bool unknownMatches,
+        bool& sawUnknown) const;
+
+private:
+    std::vector<ConditionInstruction> Code;
+
+    //! Index of the first instruction for each compiled NodeID
+    std::vector<uint32_t> ProgramStarts;
+};
+
+} // namespace smacpp
@@ -0,0 +1,54 @@
+// ------------------------------------ //
+#include "ConstantPool.h"
+
+#include <mutex>
+#include <stdexcept>
+
+using namespace smacpp;
+// ------------------------------------ //
+ConstantPool& ConstantPool::Get()
+{
+    static ConstantPool pool;
+    return pool;
+}
+// ------------------------------------ //
+ConstantPool::ConstantID ConstantPool::Intern(WideBits value)
+{
+    {
+        std::shared_lock lock(Mutex);
+        const auto found = ExistingConstants.find(value);
+
+        if(found != ExistingConstants.end())
+            return found->second;
+    }
+
+    std::unique_lock lock(Mutex);
+
+    // Another thread may have added it while the lock was released
+    const auto found = ExistingConstants.find(value);
+
+    if(found != ExistingConstants.end())
+        return found->second;
+
+    const auto id = static_cast<ConstantID>(Constants.size());
+    Constants.push_back(value);
+    ExistingConstants[value] = id;
+    return id;
+}
+// ------------------------------------ //
+ConstantPool::WideBits ConstantPool::GetConstant(ConstantID id) const
+{
+    std::shared_lock lock(Mutex);
+
+    if(id >= Constants.size())
+        throw std::out_of_range("ConstantID is not in this ConstantPool");
+
+    return Constants[id];
+}
+// ------------------------------------ //
+void ConstantPool::Clear()
+{
+    std::unique_lock lock(Mutex);
+    Constants.clear();
+    ExistingConstants.clear();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Primitive.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace smacpp {
+
+//! \brief Storage for the 128 bit constants that don't fit inline in a VariableState
+//!
+//! Equal constants share an id so VariableStates referring to them can be compared by id.
+//! Like ExpressionArena this holds the constants of a single analysis run.
+//!
+//! Arithmetic during the analysis can intern new constants, so unlike the other per-run
+//! tables this is safe to use from multiple analysis threads
+class ConstantPool {
+public:
+    using ConstantID = uint32_t;
+    using WideBits = PrimitiveInfo::WideBits;
+
+public:
+    //! \returns The pool used by the current run
+    static ConstantPool& Get();
+
+    //! \returns The id of the existing equal constant or of a newly added one
+    ConstantID Intern(WideBits value);
+
+    WideBits GetConstant(ConstantID id) const;
+
+    size_t GetConstantCount() const
+    {
+        std::shared_lock lock(Mutex);
+        return Constants.size();
+    }
+
+    //! \brief Forgets all constants, needs to be called before starting a new run
+    void Clear();
+
+private:
+    struct WideHash {
+        std::size_t operator()(WideBits value) const
+        {
+            return CombineHash(MixHash(static_cast<uint64_t>(value)),
+                MixHash(static_cast<uint64_t>(value >> 64)));
+        }
+    };
+
+    //! Indexed by ConstantID
+    std::vector<WideBits> Constants;
+
+    std::unordered_map<WideBits, ConstantID, WideHash> ExistingConstants;
+
+    mutable std::shared_mutex Mutex;
+};
+
+} // namespace smacpp
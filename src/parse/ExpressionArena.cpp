@@ -0,0 +1,39 @@
+// ------------------------------------ //
+#include "ExpressionArena.h"
+
+#include <stdexcept>
+
+using namespace smacpp;
+// ------------------------------------ //
+ExpressionArena& ExpressionArena::Get()
+{
+    static ExpressionArena arena;
+    return arena;
+}
+// ------------------------------------ //
+ExpressionArena::ExpressionID ExpressionArena::Intern(const ComputeInfo& expression)
+{
+    const auto found = ExistingExpressions.find(expression);
+
+    if(found != ExistingExpressions.end())
+        return found->second;
+
+    const auto id = static_cast<ExpressionID>(Expressions.size());
+    Expressions.push_back(expression);
+    ExistingExpressions[expression] = id;
+    return id;
+}
+// ------------------------------------ //
+const ComputeInfo& ExpressionArena::GetExpression(ExpressionID id) const
+{
+    if(id >= Expressions.size())
+        throw std::out_of_range("ExpressionID is not in this ExpressionArena");
+
+    return Expressions[id];
+}
+// ------------------------------------ //
+void ExpressionArena::Clear()
+{
+    Expressions.clear();
+    ExistingExpressions.clear();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Variable.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace smacpp {
+
+//! \brief Hash-consed storage for the computations VariableState refers to by id
+//!
+//! Each unique (operator, lhs, rhs) node is only stored once. As the operands are themselves
+//! ids for nested computations, two expressions are equal exactly when their ids are equal.
+//! Like SymbolTable this holds the expressions of a single analysis run
+class ExpressionArena {
+public:
+    using ExpressionID = VariableState::ExpressionID;
+
+public:
+    //! \returns The arena used by the current run
+    static ExpressionArena& Get();
+
+    //! \returns The id of the existing equal node or of a newly added node
+    ExpressionID Intern(const ComputeInfo& expression);
+
+    const ComputeInfo& GetExpression(ExpressionID id) const;
+
+    size_t GetExpressionCount() const
+    {
+        return Expressions.size();
+    }
+
+    //! \brief Forgets all expressions, needs to be called before starting a new run
+    void Clear();
+
+private:
+    //! Indexed by ExpressionID
+    std::vector<ComputeInfo> Expressions;
+
+    std::unordered_map<ComputeInfo, ExpressionID> ExistingExpressions;
+};
+
+} // namespace smacpp
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace smacpp {
+
+//! \brief Scrambles the bits of a value, std::hash of integers is the identity which makes
+//! combined hashes collide a lot
+inline std::size_t MixHash(uint64_t value)
+{
+    // Finalizer from MurmurHash3
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return static_cast<std::size_t>(value);
+}
+
+//! \brief Combines a hash into an existing one, order dependent
+inline std::size_t CombineHash(std::size_t seed, std::size_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+} // namespace smacpp
@@ -17,11 +17,13 @@ public:
 
     bool TraverseIntegerLiteral(clang::IntegerLiteral* value)
     {
-        VariableState state;
+        // Values wider than 128 bits are left unknown
+        const auto primitive = PrimitiveInfo::FromAPInt(
+            value->getValue(), value->getType()->isSignedIntegerType());
+
+        if(primitive)
+            FoundValue = VariableState(ApplyCurrentEffects(*primitive));
 
-        // TODO: this can only handle 64 bit numbers, anything higher will cause an error
-        state.Set(PrimitiveInfo(ApplyCurrentEffects(value->getValue().getSExtValue())));
-        FoundValue = state;
         return false;
     }
 
@@ -34,12 +36,11 @@ public:
         return true;
     }
 
-    template<typename T>
-    T ApplyCurrentEffects(const T& value)
+    PrimitiveInfo ApplyCurrentEffects(const PrimitiveInfo& value)
     {
         if(Negate) {
             Negate = false;
-            return -value;
+            return value.Negate();
         }
         return value;
     }
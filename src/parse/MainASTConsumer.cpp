@@ -2,6 +2,11 @@
 #include "MainASTConsumer.h"
 
 #include "CodeBlockBuildingVisitor.h"
+#include "ConditionArena.h"
+#include "ConditionCompiler.h"
+#include "ConstantPool.h"
+#include "ExpressionArena.h"
+#include "SymbolTable.h"
 #include "analysis/BlockRegistry.h"
 
 using namespace smacpp;
@@ -12,29 +17,44 @@ void MainASTConsumer::HandleTranslationUnit(clang::ASTContext& Context)
 
     RegisterDiagnostics(de);
 
+    // Symbols from a previous translation unit can't be referenced anymore
+    SymbolTable::Get().Clear();
+    ExpressionArena::Get().Clear();
+    ConstantPool::Get().Clear();
+    ConditionArena::Get().Clear();
+    ConditionCompiler::Get().Clear();
+
     BlockRegistry registry;
-    CodeBlockBuildingVisitor visitor(Context, registry, DebugPrint);
+    CodeBlockBuildingVisitor visitor(Context, registry, Options.Debug);
 
     // Traversing the translation unit decl via a RecursiveASTVisitor
     // will visit all nodes in the AST.
     visitor.TraverseDecl(Context.getTranslationUnitDecl());
 
+    if(Options.SSA)
+        registry.BuildSSA();
+
     // The traversal creates all the CodeBlocks in this TU
     // This analysis here can only find problems within this TU as it only has the current TU's
     // CodeBlocks loaded
-    const auto errors = registry.PerformAnalysis(DebugPrint);
+    const auto errors = registry.PerformAnalysis(Options);
 
     for(const auto& error : errors) {
-        if(error.Severity == FoundProblem::SEVERITY::Error) {
-            de.Report(error.Location, SMACPPErrorId).AddString(error.Message);
-        } else {
-            // TODO: use the proper clang error output mechanism
-            llvm::errs() << "smacpp: " << error.FormatAsString() << "\n";
+        unsigned id = SMACPPErrorId;
+
+        switch(error.Severity) {
+        case FoundProblem::SEVERITY::Error: id = SMACPPErrorId; break;
+        case FoundProblem::SEVERITY::Warning: id = SMACPPWarningId; break;
+        case FoundProblem::SEVERITY::Info: id = SMACPPInfoId; break;
         }
+
+        de.Report(error.Location, id).AddString(error.Message);
     }
 }
 // ------------------------------------ //
 void MainASTConsumer::RegisterDiagnostics(clang::DiagnosticsEngine& de)
 {
     SMACPPErrorId = de.getCustomDiagID(clang::DiagnosticsEngine::Error, "%0");
+    SMACPPWarningId = de.getCustomDiagID(clang::DiagnosticsEngine::Warning, "%0");
+    SMACPPInfoId = de.getCustomDiagID(clang::DiagnosticsEngine::Remark, "%0");
 }
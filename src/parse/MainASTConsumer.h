@@ -1,5 +1,7 @@
 #pragma once
 
+#include "analysis/AnalysisOptions.h"
+
 #include "clang/AST/AST.h"
 #include "clang/AST/ASTConsumer.h"
 
@@ -7,7 +9,7 @@ namespace smacpp {
 
 class MainASTConsumer : public clang::ASTConsumer {
 public:
-    MainASTConsumer(bool debugPrint) : DebugPrint(debugPrint) {}
+    MainASTConsumer(const AnalysisOptions& options) : Options(options) {}
 
     virtual void HandleTranslationUnit(clang::ASTContext& Context);
 
@@ -16,6 +18,8 @@ protected:
 
 protected:
     unsigned SMACPPErrorId;
-    bool DebugPrint;
+    unsigned SMACPPWarningId;
+    unsigned SMACPPInfoId;
+    AnalysisOptions Options;
 };
 } // namespace smacpp
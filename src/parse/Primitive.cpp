@@ -0,0 +1,488 @@
+// ------------------------------------ //
+#include "Primitive.h"
+
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Type.h>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+using namespace smacpp;
+// ------------------------------------ //
+namespace {
+
+using WideBits = PrimitiveInfo::WideBits;
+using SignedWide = __int128;
+
+using NormalizeFunction = WideBits (*)(WideBits bits);
+using OperatorFunction = WideBits (*)(WideBits lhs, WideBits rhs);
+using CompareFunction = bool (*)(WideBits lhs, WideBits rhs);
+
+//! The C++ type used to compare values of a PRIMITIVE_TYPE
+template<PRIMITIVE_TYPE Type>
+struct CTypeOf;
+
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::Bool> {
+    using Type = bool;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::Int8> {
+    using Type = int8_t;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::UInt8> {
+    using Type = uint8_t;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::Int16> {
+    using Type = int16_t;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::UInt16> {
+    using Type = uint16_t;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::Int32> {
+    using Type = int32_t;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::UInt32> {
+    using Type = uint32_t;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::Int64> {
+    using Type = int64_t;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::UInt64> {
+    using Type = uint64_t;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::Int128> {
+    using Type = SignedWide;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::UInt128> {
+    using Type = WideBits;
+};
+template<>
+struct CTypeOf<PRIMITIVE_TYPE::Double> {
+    using Type = double;
+};
+
+double BitsToDouble(WideBits bits)
+{
+    const auto low = static_cast<uint64_t>(bits);
+    double result;
+    std::memcpy(&result, &low, sizeof(result));
+    return result;
+}
+
+WideBits DoubleToBits(double value)
+{
+    uint64_t result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+//! \brief Truncates bits to the width of Type and sign or zero extends them back to 128 bits
+template<PRIMITIVE_TYPE Type>
+WideBits Normalize(WideBits bits)
+{
+    if constexpr(Type == PRIMITIVE_TYPE::Bool) {
+        return bits != 0 ? 1 : 0;
+    } else if constexpr(Type == PRIMITIVE_TYPE::Double) {
+        return static_cast<uint64_t>(bits);
+    } else {
+        using T = typename CTypeOf<Type>::Type;
+
+        // The casts do the truncation and extension
+        if constexpr(IsSigned(Type)) {
+            return static_cast<WideBits>(static_cast<SignedWide>(static_cast<T>(bits)));
+        } else {
+            return static_cast<WideBits>(static_cast<T>(bits));
+        }
+    }
+}
+
+template<PRIMITIVE_TYPE Type>
+typename CTypeOf<Type>::Type Load(WideBits bits)
+{
+    if constexpr(Type == PRIMITIVE_TYPE::Double) {
+        return BitsToDouble(bits);
+    } else {
+        return static_cast<typename CTypeOf<Type>::Type>(bits);
+    }
+}
+
+//! \brief Applies an operator on normalized bits of Type
+//!
+//! Integer arithmetic is done with unsigned 128 bit values, the low bits of the result only
+//! depend on the low bits of the operands so normalizing afterwards gives the C wraparound
+//! result for every width (signed overflow is treated as two's complement wraparound)
+template<PRIMITIVE_TYPE Type, OPERATOR Op>
+WideBits ApplyTyped(WideBits lhs, WideBits rhs)
+{
+    if constexpr(Type == PRIMITIVE_TYPE::Double) {
+        const double first = BitsToDouble(lhs);
+        const double second = BitsToDouble(rhs);
+
+        switch(Op) {
+        case OPERATOR::Add: return DoubleToBits(first + second);
+        case OPERATOR::Multiply: return DoubleToBits(first * second);
+        case OPERATOR::Subtract: return DoubleToBits(first - second);
+        }
+    } else {
+        switch(Op) {
+        case OPERATOR::Add: return Normalize<Type>(lhs + rhs);
+        case OPERATOR::Multiply: return Normalize<Type>(lhs * rhs);
+        case OPERATOR::Subtract: return Normalize<Type>(lhs - rhs);
+        }
+    }
+
+    return 0;
+}
+
+template<PRIMITIVE_TYPE Type, COMPARISON Op>
+bool CompareTyped(WideBits lhs, WideBits rhs)
+{
+    const auto first = Load<Type>(lhs);
+    const auto second = Load<Type>(rhs);
+
+    switch(Op) {
+    case COMPARISON::LESS_THAN: return first < second;
+    case COMPARISON::LESS_THAN_EQUAL: return first <= second;
+    case COMPARISON::GREATER_THAN: return first > second;
+    case COMPARISON::GREATER_THAN_EQUAL: return first >= second;
+    case COMPARISON::NOT_EQUAL: return first != second;
+    case COMPARISON::EQUAL: return first == second;
+    }
+
+    return false;
+}
+
+// Table generation, the tables are indexed by [type][operator]
+template<size_t... Types>
+constexpr std::array<NormalizeFunction, PRIMITIVE_TYPE_COUNT> MakeNormalizeTable(
+    std::index_sequence<Types...>)
+{
+    return {&Normalize<static_cast<PRIMITIVE_TYPE>(Types)>...};
+}
+
+template<PRIMITIVE_TYPE Type, size_t... Ops>
+constexpr std::array<OperatorFunction, OPERATOR_COUNT> MakeOperatorRow(
+    std::index_sequence<Ops...>)
+{
+    return {&ApplyTyped<Type, static_cast<OPERATOR>(Ops)>...};
+}
+
+template<size_t... Types>
+constexpr std::array<std::array<OperatorFunction, OPERATOR_COUNT>, PRIMITIVE_TYPE_COUNT>
+    MakeOperatorTable(std::index_sequence<Types...>)
+{
+    return {MakeOperatorRow<static_cast<PRIMITIVE_TYPE>(Types)>(
+        std::make_index_sequence<OPERATOR_COUNT>())...};
+}
+
+template<PRIMITIVE_TYPE Type, size_t... Ops>
+constexpr std::array<CompareFunction, COMPARISON_COUNT> MakeCompareRow(
+    std::index_sequence<Ops...>)
+{
+    return {&CompareTyped<Type, static_cast<COMPARISON>(Ops)>...};
+}
+
+template<size_t... Types>
+constexpr std::array<std::array<CompareFunction, COMPARISON_COUNT>, PRIMITIVE_TYPE_COUNT>
+    MakeCompareTable(std::index_sequence<Types...>)
+{
+    return {MakeCompareRow<static_cast<PRIMITIVE_TYPE>(Types)>(
+        std::make_index_sequence<COMPARISON_COUNT>())...};
+}
+
+//! \brief C integer promotion, everything smaller than int becomes int
+constexpr PRIMITIVE_TYPE Promote(PRIMITIVE_TYPE type)
+{
+    if(type != PRIMITIVE_TYPE::Double && BitWidth(type) < 32)
+        return PRIMITIVE_TYPE::Int32;
+
+    return type;
+}
+
+//! \brief The usual arithmetic conversions, the rank of an integer type is its width
+constexpr PRIMITIVE_TYPE ComputeCommonType(PRIMITIVE_TYPE first, PRIMITIVE_TYPE second)
+{
+    if(first == PRIMITIVE_TYPE::Double || second == PRIMITIVE_TYPE::Double)
+        return PRIMITIVE_TYPE::Double;
+
+    first = Promote(first);
+    second = Promote(second);
+
+    if(first == second)
+        return first;
+
+    if(IsSigned(first) == IsSigned(second))
+        return BitWidth(first) > BitWidth(second) ? first : second;
+
+    const auto unsignedType = IsSigned(first) ? second : first;
+    const auto signedType = IsSigned(first) ? first : second;
+
+    // A wider signed type can represent all values of the unsigned type
+    return BitWidth(unsignedType) >= BitWidth(signedType) ? unsignedType : signedType;
+}
+
+using CommonTypes =
+    std::array<std::array<PRIMITIVE_TYPE, PRIMITIVE_TYPE_COUNT>, PRIMITIVE_TYPE_COUNT>;
+
+constexpr CommonTypes MakeCommonTypeTable()
+{
+    CommonTypes result{};
+
+    for(size_t first = 0; first < PRIMITIVE_TYPE_COUNT; ++first) {
+        for(size_t second = 0; second < PRIMITIVE_TYPE_COUNT; ++second) {
+            result[first][second] = ComputeCommonType(
+                static_cast<PRIMITIVE_TYPE>(first), static_cast<PRIMITIVE_TYPE>(second));
+        }
+    }
+
+    return result;
+}
+
+constexpr auto NormalizeTable =
+    MakeNormalizeTable(std::make_index_sequence<PRIMITIVE_TYPE_COUNT>());
+constexpr auto OperatorTable =
+    MakeOperatorTable(std::make_index_sequence<PRIMITIVE_TYPE_COUNT>());
+constexpr auto CompareTable =
+    MakeCompareTable(std::make_index_sequence<PRIMITIVE_TYPE_COUNT>());
+constexpr auto CommonTypeTable = MakeCommonTypeTable();
+
+static_assert(CommonTypeTable[static_cast<size_t>(PRIMITIVE_TYPE::Int32)]
+                             [static_cast<size_t>(PRIMITIVE_TYPE::UInt32)] ==
+                  PRIMITIVE_TYPE::UInt32,
+    "int and unsigned int should convert to unsigned int");
+static_assert(CommonTypeTable[static_cast<size_t>(PRIMITIVE_TYPE::UInt8)]
+                             [static_cast<size_t>(PRIMITIVE_TYPE::UInt16)] ==
+                  PRIMITIVE_TYPE::Int32,
+    "small types should be promoted to int");
+static_assert(CommonTypeTable[static_cast<size_t>(PRIMITIVE_TYPE::Int64)]
+                             [static_cast<size_t>(PRIMITIVE_TYPE::UInt32)] ==
+                  PRIMITIVE_TYPE::Int64,
+    "long long should hold all unsigned int values");
+
+constexpr size_t Index(PRIMITIVE_TYPE type)
+{
+    return static_cast<size_t>(type);
+}
+
+std::string WideToString(WideBits value, bool negative)
+{
+    if(negative)
+        value = ~value + 1;
+
+    std::string result;
+
+    do {
+        result.insert(result.begin(), static_cast<char>('0' + static_cast<int>(value % 10)));
+        value /= 10;
+    } while(value != 0);
+
+    if(negative)
+        result.insert(result.begin(), '-');
+
+    return result;
+}
+
+} // namespace
+// ------------------------------------ //
+std::optional<PRIMITIVE_TYPE> smacpp::IntegerType(unsigned width, bool isSigned)
+{
+    switch(width) {
+    case 1: return PRIMITIVE_TYPE::Bool;
+    case 8: return isSigned ? PRIMITIVE_TYPE::Int8 : PRIMITIVE_TYPE::UInt8;
+    case 16: return isSigned ? PRIMITIVE_TYPE::Int16 : PRIMITIVE_TYPE::UInt16;
+    case 32: return isSigned ? PRIMITIVE_TYPE::Int32 : PRIMITIVE_TYPE::UInt32;
+    case 64: return isSigned ? PRIMITIVE_TYPE::Int64 : PRIMITIVE_TYPE::UInt64;
+    case 128: return isSigned ? PRIMITIVE_TYPE::Int128 : PRIMITIVE_TYPE::UInt128;
+    default: return std::optional<PRIMITIVE_TYPE>{};
+    }
+}
+
+std::optional<PRIMITIVE_TYPE> smacpp::PrimitiveTypeOf(
+    clang::QualType type, const clang::ASTContext& context)
+{
+    if(type.isNull())
+        return std::optional<PRIMITIVE_TYPE>{};
+
+    const auto canonical = type.getCanonicalType();
+
+    if(canonical->isBooleanType())
+        return PRIMITIVE_TYPE::Bool;
+
+    // TODO: float and long double are approximated with double
+    if(canonical->isRealFloatingType())
+        return PRIMITIVE_TYPE::Double;
+
+    if(canonical->isIntegerType()) {
+        return IntegerType(static_cast<unsigned>(context.getTypeSize(canonical)),
+            canonical->isSignedIntegerType());
+    }
+
+    return std::optional<PRIMITIVE_TYPE>{};
+}
+
+const char* smacpp::Dump(PRIMITIVE_TYPE type)
+{
+    switch(type) {
+    case PRIMITIVE_TYPE::Bool: return "bool";
+    case PRIMITIVE_TYPE::Int8: return "int8";
+    case PRIMITIVE_TYPE::UInt8: return "uint8";
+    case PRIMITIVE_TYPE::Int16: return "int16";
+    case PRIMITIVE_TYPE::UInt16: return "uint16";
+    case PRIMITIVE_TYPE::Int32: return "int32";
+    case PRIMITIVE_TYPE::UInt32: return "uint32";
+    case PRIMITIVE_TYPE::Int64: return "int64";
+    case PRIMITIVE_TYPE::UInt64: return "uint64";
+    case PRIMITIVE_TYPE::Int128: return "int128";
+    case PRIMITIVE_TYPE::UInt128: return "uint128";
+    case PRIMITIVE_TYPE::Double: return "double";
+    }
+
+    throw std::runtime_error("dump not implemented for this PRIMITIVE_TYPE");
+}
+
+PRIMITIVE_TYPE smacpp::CommonType(PRIMITIVE_TYPE first, PRIMITIVE_TYPE second)
+{
+    return CommonTypeTable[Index(first)][Index(second)];
+}
+// ------------------------------------ //
+// PrimitiveInfo
+PrimitiveInfo::PrimitiveInfo(Integer intValue) :
+    Type(PRIMITIVE_TYPE::Int64), Bits(static_cast<WideBits>(static_cast<SignedWide>(intValue)))
+{}
+
+PrimitiveInfo::PrimitiveInfo(PRIMITIVE_TYPE type, WideBits bits) :
+    Type(type), Bits(NormalizeTable[Index(type)](bits))
+{}
+
+PrimitiveInfo PrimitiveInfo::FromBool(bool value)
+{
+    return PrimitiveInfo(PRIMITIVE_TYPE::Bool, value ? 1 : 0);
+}
+
+PrimitiveInfo PrimitiveInfo::FromDouble(double value)
+{
+    return PrimitiveInfo(PRIMITIVE_TYPE::Double, DoubleToBits(value));
+}
+
+std::optional<PrimitiveInfo> PrimitiveInfo::FromAPInt(const llvm::APInt& value, bool isSigned)
+{
+    const auto type = IntegerType(value.getBitWidth(), isSigned);
+
+    if(!type)
+        return std::optional<PrimitiveInfo>{};
+
+    const auto extended = isSigned ? value.sext(128) : value.zext(128);
+    const uint64_t* words = extended.getRawData();
+
+    return PrimitiveInfo(*type, (static_cast<WideBits>(words[1]) << 64) | words[0]);
+}
+// ------------------------------------ //
+bool PrimitiveInfo::IsNonZero() const
+{
+    if(Type == PRIMITIVE_TYPE::Double)
+        return BitsToDouble(Bits) != 0;
+
+    return Bits != 0;
+}
+
+PrimitiveInfo::Integer PrimitiveInfo::AsInteger() const
+{
+    if(Type == PRIMITIVE_TYPE::Double)
+        return static_cast<Integer>(BitsToDouble(Bits));
+
+    return static_cast<Integer>(Bits);
+}
+
+double PrimitiveInfo::AsDouble() const
+{
+    if(Type == PRIMITIVE_TYPE::Double)
+        return BitsToDouble(Bits);
+
+    if(IsSigned(Type))
+        return static_cast<double>(static_cast<SignedWide>(Bits));
+
+    return static_cast<double>(Bits);
+}
+
+PrimitiveInfo::SignedWide PrimitiveInfo::AsSignedWide() const
+{
+    if(Type == PRIMITIVE_TYPE::Double)
+        return static_cast<SignedWide>(ConvertTo(PRIMITIVE_TYPE::Int128).Bits);
+
+    // Bits are extended according to the signedness so this gives the mathematical value
+    return static_cast<SignedWide>(Bits);
+}
+
+PrimitiveInfo PrimitiveInfo::ConvertTo(PRIMITIVE_TYPE type) const
+{
+    if(type == Type)
+        return *this;
+
+    if(type == PRIMITIVE_TYPE::Bool)
+        return FromBool(IsNonZero());
+
+    if(type == PRIMITIVE_TYPE::Double)
+        return FromDouble(AsDouble());
+
+    if(Type == PRIMITIVE_TYPE::Double) {
+        // Out of range conversions are undefined in C, those and NaN become 0
+        const double value = std::trunc(BitsToDouble(Bits));
+
+        if(!(value > -1.7e38 && value < 1.7e38))
+            return PrimitiveInfo(type, 0);
+
+        return PrimitiveInfo(type, static_cast<WideBits>(static_cast<SignedWide>(value)));
+    }
+
+    // Bits are already extended according to the source type so this only needs truncating
+    return PrimitiveInfo(type, Bits);
+}
+// ------------------------------------ //
+bool PrimitiveInfo::CompareTo(COMPARISON op, const PrimitiveInfo& other) const
+{
+    const auto type = CommonTypeTable[Index(Type)][Index(other.Type)];
+
+    return CompareTable[Index(type)][static_cast<size_t>(op)](
+        ConvertTo(type).Bits, other.ConvertTo(type).Bits);
+}
+
+PrimitiveInfo PrimitiveInfo::ApplyOperator(OPERATOR op, const PrimitiveInfo& other) const
+{
+    const auto type = CommonTypeTable[Index(Type)][Index(other.Type)];
+
+    PrimitiveInfo result(type, 0);
+    result.Bits = OperatorTable[Index(type)][static_cast<size_t>(op)](
+        ConvertTo(type).Bits, other.ConvertTo(type).Bits);
+    return result;
+}
+
+PrimitiveInfo PrimitiveInfo::Negate() const
+{
+    if(Type == PRIMITIVE_TYPE::Double)
+        return FromDouble(-BitsToDouble(Bits));
+
+    return PrimitiveInfo(Promote(Type), 0).ApplyOperator(OPERATOR::Subtract, *this);
+}
+// ------------------------------------ //
+std::string PrimitiveInfo::Dump() const
+{
+    switch(Type) {
+    case PRIMITIVE_TYPE::Bool: return Bits != 0 ? "true" : "false";
+    case PRIMITIVE_TYPE::Double: return std::to_string(BitsToDouble(Bits));
+    default:
+        return WideToString(Bits, IsSigned(Type) && static_cast<SignedWide>(Bits) < 0);
+    }
+}
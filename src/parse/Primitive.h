@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Hashing.h"
+
+#include <llvm/ADT/APInt.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace clang {
+class ASTContext;
+class QualType;
+} // namespace clang
+
+namespace smacpp {
+
+//! \todo The values inside should be renamed to match naming convention
+enum class COMPARISON {
+    LESS_THAN,
+    LESS_THAN_EQUAL,
+    GREATER_THAN,
+    GREATER_THAN_EQUAL,
+    NOT_EQUAL,
+    EQUAL
+};
+
+constexpr size_t COMPARISON_COUNT = static_cast<size_t>(COMPARISON::EQUAL) + 1;
+
+enum class OPERATOR { Add, Multiply, Subtract };
+
+constexpr size_t OPERATOR_COUNT = static_cast<size_t>(OPERATOR::Subtract) + 1;
+
+//! \brief C type of a primitive value. Integer types are identified by their width and
+//! signedness as that is all that affects their arithmetic
+enum class PRIMITIVE_TYPE : uint8_t {
+    Bool,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Int128,
+    UInt128,
+    Double
+};
+
+constexpr size_t PRIMITIVE_TYPE_COUNT = static_cast<size_t>(PRIMITIVE_TYPE::Double) + 1;
+
+constexpr bool IsSigned(PRIMITIVE_TYPE type)
+{
+    switch(type) {
+    case PRIMITIVE_TYPE::Int8:
+    case PRIMITIVE_TYPE::Int16:
+    case PRIMITIVE_TYPE::Int32:
+    case PRIMITIVE_TYPE::Int64:
+    case PRIMITIVE_TYPE::Int128:
+    case PRIMITIVE_TYPE::Double: return true;
+    default: return false;
+    }
+}
+
+//! \returns The width in bits, 1 for bool
+constexpr unsigned BitWidth(PRIMITIVE_TYPE type)
+{
+    switch(type) {
+    case PRIMITIVE_TYPE::Bool: return 1;
+    case PRIMITIVE_TYPE::Int8:
+    case PRIMITIVE_TYPE::UInt8: return 8;
+    case PRIMITIVE_TYPE::Int16:
+    case PRIMITIVE_TYPE::UInt16: return 16;
+    case PRIMITIVE_TYPE::Int32:
+    case PRIMITIVE_TYPE::UInt32: return 32;
+    case PRIMITIVE_TYPE::Int64:
+    case PRIMITIVE_TYPE::UInt64:
+    case PRIMITIVE_TYPE::Double: return 64;
+    case PRIMITIVE_TYPE::Int128:
+    case PRIMITIVE_TYPE::UInt128: return 128;
+    }
+
+    return 0;
+}
+
+//! \returns The integer type with the width and signedness or empty if there isn't one
+std::optional<PRIMITIVE_TYPE> IntegerType(unsigned width, bool isSigned);
+
+//! \returns The type used for values of a clang type or empty if it isn't a supported
+//! arithmetic type
+std::optional<PRIMITIVE_TYPE> PrimitiveTypeOf(
+    clang::QualType type, const clang::ASTContext& context);
+
+const char* Dump(PRIMITIVE_TYPE type);
+
+//! \brief A known value of a C arithmetic type
+//!
+//! Integers are stored as their value extended to 128 bits according to the signedness of the
+//! type so the same value of a type always has the same bits. Operations follow the C rules:
+//! the operands are converted to their common type and the result wraps around at the width
+//! of that type. The operations are dispatched through tables indexed by the type and
+//! operator, see Primitive.cpp
+struct PrimitiveInfo {
+public:
+    using Integer = long long;
+
+    //! Bits of a value, doubles are stored as their bit pattern
+    using WideBits = unsigned __int128;
+    using SignedWide = __int128;
+
+public:
+    //! \brief Creates a long long value
+    PrimitiveInfo(Integer intValue);
+
+    //! \brief Creates a value from bits, they are truncated to the width of type
+    PrimitiveInfo(PRIMITIVE_TYPE type, WideBits bits);
+
+    static PrimitiveInfo FromBool(bool value);
+    static PrimitiveInfo FromDouble(double value);
+
+    //! \brief Creates a value from an integer literal
+    //! \returns Empty if the value is wider than 128 bits
+    static std::optional<PrimitiveInfo> FromAPInt(const llvm::APInt& value, bool isSigned);
+
+    bool IsNonZero() const;
+    Integer AsInteger() const;
+    double AsDouble() const;
+
+    //! \returns The value as a 128 bit signed integer, unsigned 128 bit values over its range
+    //! wrap around and doubles are truncated
+    SignedWide AsSignedWide() const;
+
+    //! \brief Converts to another type like a C cast does
+    PrimitiveInfo ConvertTo(PRIMITIVE_TYPE type) const;
+
+    std::string Dump() const;
+
+    bool CompareTo(COMPARISON op, const PrimitiveInfo& other) const;
+    PrimitiveInfo ApplyOperator(OPERATOR op, const PrimitiveInfo& other) const;
+
+    //! \brief Unary minus
+    PrimitiveInfo Negate() const;
+
+    bool operator==(const PrimitiveInfo& other) const
+    {
+        return Type == other.Type && Bits == other.Bits;
+    }
+
+    bool operator!=(const PrimitiveInfo& other) const
+    {
+        return !(*this == other);
+    }
+
+    std::size_t Hash() const
+    {
+        return CombineHash(MixHash(static_cast<uint64_t>(Bits)),
+            CombineHash(MixHash(static_cast<uint64_t>(Bits >> 64)),
+                static_cast<std::size_t>(Type)));
+    }
+
+    PRIMITIVE_TYPE Type;
+    WideBits Bits;
+};
+
+//! \returns The type both operands are converted to before a binary operation, this is the
+//! result of the C usual arithmetic conversions
+PRIMITIVE_TYPE CommonType(PRIMITIVE_TYPE first, PRIMITIVE_TYPE second);
+
+} // namespace smacpp
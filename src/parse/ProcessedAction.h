@@ -3,103 +3,74 @@
 #include "Condition.h"
 #include "Variable.h"
 
-#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
 
 namespace smacpp {
 
-class AnalysisOperation;
-
-//! \brief Some action the program takes that is relevant for static analysis
-class ProcessedAction {
-public:
-    ProcessedAction(Condition condition) : If(condition) {}
-    virtual ~ProcessedAction() = default;
-
-    virtual std::string Dump() const;
-
-    virtual void Dispatch(AnalysisOperation& receiver) const = 0;
-
-protected:
-    virtual void DumpSpecialized(std::stringstream& sstream) const = 0;
-
-public:
-    //! Action is taken when this condition is true
-    const Condition If;
-    //! This is not const to reduce the constructor param count
-    clang::SourceLocation Location;
-};
-
 namespace action {
-class VarDeclared : public ProcessedAction {
-public:
-    VarDeclared(Condition condition, VariableIdentifier var, VariableState state) :
-        ProcessedAction(condition), Variable(var), State(state)
-    {}
-
-    void Dispatch(AnalysisOperation& receiver) const override;
-
-protected:
-    void DumpSpecialized(std::stringstream& sstream) const override;
-
-public:
-    const VariableIdentifier Variable;
-    const VariableState State;
+struct VarDeclared {
+    VariableIdentifier Variable;
+    VariableState State;
 };
 
-class VarAssigned : public ProcessedAction {
-public:
-    VarAssigned(Condition condition, VariableIdentifier var, VariableState state) :
-        ProcessedAction(condition), Variable(var), State(state)
-    {}
-
-    void Dispatch(AnalysisOperation& receiver) const override;
-
-protected:
-    void DumpSpecialized(std::stringstream& sstream) const override;
-
-public:
-    const VariableIdentifier Variable;
-    const VariableState State;
+struct VarAssigned {
+    VariableIdentifier Variable;
+    VariableState State;
 };
 
 //! \brief Array index read that should be checked to be within the buffer size
-class ArrayIndexAccess : public ProcessedAction {
-public:
-    ArrayIndexAccess(Condition condition, VariableIdentifier array, VariableState index) :
-        ProcessedAction(condition), Array(array), Index(index)
-    {}
-
-    void Dispatch(AnalysisOperation& receiver) const override;
-
-protected:
-    void DumpSpecialized(std::stringstream& sstream) const override;
-
-public:
-    const VariableIdentifier Array;
-    const VariableState Index;
+struct ArrayIndexAccess {
+    VariableIdentifier Array;
+    VariableState Index;
 };
 
-class FunctionCall : public ProcessedAction {
-public:
-    FunctionCall(Condition condition, const std::string& function,
-        const std::vector<VariableState>& params) :
-        ProcessedAction(condition),
-        Function(function), Params(params)
-    {}
-
-    void Dispatch(AnalysisOperation& receiver) const override;
-
-protected:
-    void DumpSpecialized(std::stringstream& sstream) const override;
-
-public:
-    const std::string Function;
-    const std::vector<VariableState> Params;
+//! \brief A call, the callee name and parameters are in the CodeBlock call table
+struct FunctionCall {
+    uint32_t Call;
 };
 
+//! \brief Callee and parameters of a FunctionCall
+struct CallInfo {
+    std::string Function;
+    std::vector<VariableState> Params;
+};
 
+} // namespace action
 
-}; // namespace action
+//! \brief Some action the program takes that is relevant for static analysis
+//!
+//! Actions are stored by value in a contiguous tape in CodeBlock so that the analysis can
+//! scan through them linearly. Data that is only needed for reporting and dumping is kept in
+//! side arrays in the CodeBlock, indexed by the position of the action. The condition under
+//! which an action is taken is stored in the ActionGroup it belongs to
+struct ProcessedAction {
+    using Data = std::variant<action::VarDeclared, action::VarAssigned,
+        action::ArrayIndexAccess, action::FunctionCall>;
+
+    Data Action;
+};
 
+//! \brief A run of consecutive actions guarded by the same condition
+//!
+//! Like a basic block the guard is evaluated once when the group is reached, so changes the
+//! actions in the group make to the variables of the guard don't affect the later actions of
+//! the same group.
+//! \note This only holds within a group. A nested statement ends the group and the actions
+//! after it start a new group with the same guard, which is evaluated again against the
+//! changed state. So unlike in C a body that changes the variables of its own condition can
+//! skip the actions after a nested if or switch
+struct ActionGroup {
+    //! The actions are taken when this condition is true
+    Condition If;
+
+    //! Index of If in the distinct guards of the CodeBlock
+    uint32_t Guard;
+
+    //! Range of the actions in the action tape, End is one past the last action
+    uint32_t Begin;
+    uint32_t End;
+};
 
 } // namespace smacpp
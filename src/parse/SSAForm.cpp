@@ -0,0 +1,190 @@
+// ------------------------------------ //
+#include "SSAForm.h"
+
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+
+using namespace smacpp;
+// ------------------------------------ //
+SSAForm::SSAForm(const CodeBlock& block)
+{
+    // Current value of each variable while walking the actions in order
+    std::unordered_map<SymbolTable::SymbolID, ValueID> current;
+
+    const auto currentValue = [&](const VariableIdentifier& variable) {
+        const auto found = current.find(variable.ID);
+
+        if(found != current.end())
+            return found->second;
+
+        const auto id = static_cast<ValueID>(Values.size());
+        Values.push_back(Value{Value::KIND::Entry, variable, 0, id, id});
+        EntryValues.push_back(id);
+        current[variable.ID] = id;
+        return id;
+    };
+
+    const auto beginRange = [&]() {
+        return OperandRange{static_cast<uint32_t>(Operands.size()), 0};
+    };
+
+    const auto endRange = [&](OperandRange range) {
+        range.End = static_cast<uint32_t>(Operands.size());
+        return range;
+    };
+
+    const auto& groups = block.GetActionGroups();
+
+    for(size_t group = 0; group < groups.size(); ++group) {
+        const ActionGroup& actionGroup = groups[group];
+
+        auto range = beginRange();
+        for(const auto& variable : block.GetGuardReads(actionGroup.Guard))
+            Operands.push_back(currentValue(variable));
+        GroupReads.push_back(endRange(range));
+
+        // Variables written in this group and their value from before the group
+        std::vector<std::tuple<VariableIdentifier, ValueID>> written;
+
+        for(size_t i = actionGroup.Begin; i < actionGroup.End; ++i) {
+
+            range = beginRange();
+            for(const auto& variable : block.GetActionReads(i))
+                Operands.push_back(currentValue(variable));
+            ActionReads.push_back(endRange(range));
+
+            range = beginRange();
+            for(const auto& variable : block.GetActionWrites(i)) {
+                const auto previous = currentValue(variable);
+
+                bool first = true;
+                for(const auto& [writtenVariable, before] : written) {
+                    if(writtenVariable == variable)
+                        first = false;
+                }
+
+                if(first)
+                    written.emplace_back(variable, previous);
+
+                const auto id = static_cast<ValueID>(Values.size());
+                Values.push_back(Value{
+                    Value::KIND::Action, variable, static_cast<uint32_t>(i), previous, id});
+                Operands.push_back(id);
+                current[variable.ID] = id;
+            }
+            ActionDefinitions.push_back(endRange(range));
+        }
+
+        range = beginRange();
+
+        if(!actionGroup.If.IsAlwaysTrue()) {
+            for(const auto& [variable, before] : written) {
+                const auto id = static_cast<ValueID>(Values.size());
+                Values.push_back(Value{Value::KIND::Phi, variable,
+                    static_cast<uint32_t>(group), before, current[variable.ID]});
+                Operands.push_back(id);
+                current[variable.ID] = id;
+            }
+        }
+
+        GroupPhis.push_back(endRange(range));
+    }
+
+    ComputeLiveness(block);
+}
+// ------------------------------------ //
+void SSAForm::ComputeLiveness(const CodeBlock& block)
+{
+    const auto& actions = block.GetActions();
+    const auto& groups = block.GetActionGroups();
+
+    LiveActions.assign(actions.size(), false);
+    LiveGroups.assign(groups.size(), false);
+    LiveValues.assign(Values.size(), false);
+
+    std::vector<size_t> groupOfAction(actions.size());
+
+    for(size_t group = 0; group < groups.size(); ++group) {
+        for(size_t i = groups[group].Begin; i < groups[group].End; ++i)
+            groupOfAction[i] = group;
+    }
+
+    std::vector<ValueID> worklist;
+
+    const auto markValues = [&](ArrayView<ValueID> values) {
+        for(const auto value : values) {
+            if(!LiveValues[value]) {
+                LiveValues[value] = true;
+                worklist.push_back(value);
+            }
+        }
+    };
+
+    const auto markGroup = [&](size_t group) {
+        if(!LiveGroups[group]) {
+            LiveGroups[group] = true;
+            markValues(GetGroupReads(group));
+        }
+    };
+
+    const auto markAction = [&](size_t index) {
+        if(!LiveActions[index]) {
+            LiveActions[index] = true;
+            markGroup(groupOfAction[index]);
+            markValues(GetActionReads(index));
+        }
+    };
+
+    for(size_t i = 0; i < actions.size(); ++i) {
+        if(std::holds_alternative<action::ArrayIndexAccess>(actions[i].Action) ||
+            std::holds_alternative<action::FunctionCall>(actions[i].Action))
+            markAction(i);
+    }
+
+    while(!worklist.empty()) {
+        const auto& value = Values[worklist.back()];
+        worklist.pop_back();
+
+        switch(value.Kind) {
+        case Value::KIND::Entry: break;
+        case Value::KIND::Action:
+            markAction(value.Source);
+            break;
+        case Value::KIND::Phi:
+            markGroup(value.Source);
+            markValues(ArrayView<ValueID>{&value.Previous, &value.Previous + 1});
+            markValues(ArrayView<ValueID>{&value.Incoming, &value.Incoming + 1});
+            break;
+        }
+    }
+}
+// ------------------------------------ //
+std::string SSAForm::Dump() const
+{
+    std::stringstream sstream;
+
+    sstream << "SSA values:\n";
+
+    for(size_t i = 0; i < Values.size(); ++i) {
+        const auto& value = Values[i];
+
+        sstream << (LiveValues[i] ? " %" : " dead %") << i << " " << value.Variable.Dump()
+                << " = ";
+
+        switch(value.Kind) {
+        case Value::KIND::Entry: sstream << "entry"; break;
+        case Value::KIND::Action:
+            sstream << "action " << value.Source << " (previous %" << value.Previous << ")";
+            break;
+        case Value::KIND::Phi:
+            sstream << "phi group " << value.Source << " ? %" << value.Incoming << " : %"
+                    << value.Previous;
+            break;
+        }
+
+        sstream << "\n";
+    }
+
+    return sstream.str();
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "CodeBlock.h"
+
+#include <vector>
+
+namespace smacpp {
+
+//! \brief Static single assignment form of the actions of a CodeBlock
+//!
+//! Every write of a variable defines a new value and every read refers directly to the value
+//! that is current at that point. As the actions are flattened with their guards there is
+//! no control flow graph, a group with a guard that isn't always true instead ends with a
+//! gated phi for each variable it writes. The phi selects the value from the end of the
+//! group if the guard was true and the value from before the group otherwise.
+//!
+//! The operand lists are aligned with the dependency index of the CodeBlock, so the read of
+//! GetActionReads(i)[n] in the block is the value GetActionReads(i)[n] here.
+//!
+//! The def-use chains are also walked backwards from the sinks (array accesses and calls) to
+//! find the actions and guards that can affect them, the rest can be skipped when analysing
+class SSAForm {
+public:
+    using ValueID = uint32_t;
+
+    struct Value {
+        enum class KIND : uint8_t {
+            //! The value the variable has when the function starts
+            Entry,
+            //! Defined by the action Source
+            Action,
+            //! Selects Incoming if the guard of the group Source is true, Previous otherwise
+            Phi
+        };
+
+        KIND Kind;
+        VariableIdentifier Variable;
+        uint32_t Source;
+
+        //! Value of the variable before this
+        ValueID Previous;
+        ValueID Incoming;
+    };
+
+public:
+    explicit SSAForm(const CodeBlock& block);
+
+    const Value& GetValue(ValueID id) const
+    {
+        return Values[id];
+    }
+
+    size_t GetValueCount() const
+    {
+        return Values.size();
+    }
+
+    //! \returns The values that need to be initialized from the state at function entry
+    const auto& GetEntryValues() const
+    {
+        return EntryValues;
+    }
+
+    ArrayView<ValueID> GetActionReads(size_t index) const
+    {
+        return MakeView(ActionReads[index]);
+    }
+
+    ArrayView<ValueID> GetActionDefinitions(size_t index) const
+    {
+        return MakeView(ActionDefinitions[index]);
+    }
+
+    //! \returns The values the guard of a group reads
+    ArrayView<ValueID> GetGroupReads(size_t group) const
+    {
+        return MakeView(GroupReads[group]);
+    }
+
+    ArrayView<ValueID> GetGroupPhis(size_t group) const
+    {
+        return MakeView(GroupPhis[group]);
+    }
+
+    //! \returns True if the action can affect a sink
+    bool IsActionLive(size_t index) const
+    {
+        return LiveActions[index];
+    }
+
+    //! \returns True if the result of the guard of a group can affect a sink
+    bool IsGroupLive(size_t group) const
+    {
+        return LiveGroups[group];
+    }
+
+    bool IsValueLive(ValueID id) const
+    {
+        return LiveValues[id];
+    }
+
+    std::string Dump() const;
+
+private:
+    //! \brief Marks everything the sinks of block transitively depend on as live
+    void ComputeLiveness(const CodeBlock& block);
+
+private:
+    struct OperandRange {
+        uint32_t Begin;
+        uint32_t End;
+    };
+
+    ArrayView<ValueID> MakeView(OperandRange range) const
+    {
+        return ArrayView<ValueID>{Operands.data() + range.Begin, Operands.data() + range.End};
+    }
+
+private:
+    //! Indexed by ValueID
+    std::vector<Value> Values;
+    std::vector<ValueID> EntryValues;
+
+    //! Storage for all the ranges below
+    std::vector<ValueID> Operands;
+
+    //! Indexed by action
+    std::vector<OperandRange> ActionReads;
+    std::vector<OperandRange> ActionDefinitions;
+
+    //! Indexed by action group
+    std::vector<OperandRange> GroupReads;
+    std::vector<OperandRange> GroupPhis;
+
+    std::vector<bool> LiveActions;
+    std::vector<bool> LiveGroups;
+    std::vector<bool> LiveValues;
+};
+
+//! \brief Provides the values a single action or guard reads from a flat SSA value vector
+//!
+//! The read variables are only a handful so they are searched linearly
+class SSAValueProvider : public VariableValueProvider {
+public:
+    SSAValueProvider(ArrayView<VariableIdentifier> variables,
+        ArrayView<SSAForm::ValueID> versions, const std::vector<VariableState>& values) :
+        Variables(variables),
+        Versions(versions), Values(values)
+    {}
+
+    //! Values are stored resolved so this doesn't need to resolve anything
+    VariableState GetVariableValue(const VariableIdentifier& variable) const override
+    {
+        return GetVariableValueRaw(variable);
+    }
+
+    VariableState GetVariableValueRaw(const VariableIdentifier& variable) const override
+    {
+        for(size_t i = 0; i < Variables.size(); ++i) {
+            if(Variables.First[i] == variable)
+                return Values[Versions.First[i]];
+        }
+
+        return VariableState();
+    }
+
+private:
+    ArrayView<VariableIdentifier> Variables;
+    ArrayView<SSAForm::ValueID> Versions;
+    const std::vector<VariableState>& Values;
+};
+
+} // namespace smacpp
@@ -0,0 +1,67 @@
+// ------------------------------------ //
+#include "SymbolTable.h"
+
+#include <stdexcept>
+
+using namespace smacpp;
+// ------------------------------------ //
+SymbolTable& SymbolTable::Get()
+{
+    static SymbolTable table;
+    return table;
+}
+// ------------------------------------ //
+SymbolTable::SymbolID SymbolTable::Intern(const clang::VarDecl* var)
+{
+    // Redeclarations (for example extern globals) need to map to the same symbol
+    var = var->getCanonicalDecl();
+
+    const auto found = Declarations.find(var);
+
+    if(found != Declarations.end())
+        return found->second;
+
+    const auto id = static_cast<SymbolID>(Names.size());
+    Names.push_back(var->getQualifiedNameAsString());
+    FrameSlots.push_back(NO_SLOT);
+    Declarations[var] = id;
+    return id;
+}
+
+SymbolTable::SymbolID SymbolTable::Intern(const std::string& name)
+{
+    const auto found = NamedSymbols.find(name);
+
+    if(found != NamedSymbols.end())
+        return found->second;
+
+    const auto id = static_cast<SymbolID>(Names.size());
+    Names.push_back(name);
+    FrameSlots.push_back(NO_SLOT);
+    NamedSymbols[name] = id;
+    return id;
+}
+// ------------------------------------ //
+const std::string& SymbolTable::GetName(SymbolID id) const
+{
+    if(id >= Names.size())
+        throw std::out_of_range("SymbolID is not in this SymbolTable");
+
+    return Names[id];
+}
+
+void SymbolTable::SetFrameSlot(SymbolID id, FrameSlot slot)
+{
+    if(id >= FrameSlots.size())
+        throw std::out_of_range("SymbolID is not in this SymbolTable");
+
+    FrameSlots[id] = slot;
+}
+// ------------------------------------ //
+void SymbolTable::Clear()
+{
+    Declarations.clear();
+    NamedSymbols.clear();
+    Names.clear();
+    FrameSlots.clear();
+}
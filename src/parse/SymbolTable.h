@@ -0,0 +1,61 @@
+#pragma once
+
+#include <clang/AST/Decl.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace smacpp {
+
+//! \brief Maps variables to dense integer ids for a single analysis run
+//!
+//! Each clang::VarDecl is interned only once so that the analysis can compare and hash
+//! plain integers. The names are only stored here for Dump() purposes
+class SymbolTable {
+public:
+    using SymbolID = uint32_t;
+    using FrameSlot = uint32_t;
+
+    //! Marks symbols that aren't a local variable or a parameter of any CodeBlock
+    static constexpr FrameSlot NO_SLOT = UINT32_MAX;
+
+public:
+    //! \returns The table used by the current run
+    static SymbolTable& Get();
+
+    SymbolID Intern(const clang::VarDecl* var);
+
+    //! \brief Interns a variable that has no declaration, these are only matched by name
+    SymbolID Intern(const std::string& name);
+
+    const std::string& GetName(SymbolID id) const;
+
+    //! \brief Records the slot the CodeBlock owning this symbol gave it
+    void SetFrameSlot(SymbolID id, FrameSlot slot);
+
+    //! \returns The frame slot of a symbol or NO_SLOT
+    FrameSlot GetFrameSlot(SymbolID id) const
+    {
+        return id < FrameSlots.size() ? FrameSlots[id] : NO_SLOT;
+    }
+
+    size_t GetSymbolCount() const
+    {
+        return Names.size();
+    }
+
+    //! \brief Forgets all symbols, needs to be called before starting a new run
+    void Clear();
+
+private:
+    std::unordered_map<const clang::VarDecl*, SymbolID> Declarations;
+    std::unordered_map<std::string, SymbolID> NamedSymbols;
+
+    //! Indexed by SymbolID
+    std::vector<std::string> Names;
+    std::vector<FrameSlot> FrameSlots;
+};
+
+} // namespace smacpp
@@ -2,16 +2,129 @@
 #include "Variable.h"
 
 #include "parse/Condition.h"
+#include "parse/ConstantPool.h"
+#include "parse/ExpressionArena.h"
 
 #include <clang/AST/Decl.h>
 
+#include <algorithm>
+
+
 using namespace smacpp;
 // ------------------------------------ //
+namespace {
+
+using SignedWide = PrimitiveInfo::SignedWide;
+
+bool FitsInt32(int64_t value)
+{
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+bool Contains(const IntervalInfo& interval, SignedWide value)
+{
+    return interval.Low <= value && value <= interval.High;
+}
+
+//! \returns False if C would compare or combine the intervals in an unsigned type while one
+//! of them has negative values, these wrap around so the bounds don't apply
+bool HaveCompatibleSigns(const IntervalInfo& lhs, const IntervalInfo& rhs)
+{
+    return IsSigned(CommonType(lhs.Type, rhs.Type)) || (lhs.Low >= 0 && rhs.Low >= 0);
+}
+
+TRI_STATE CompareIntervals(COMPARISON op, const IntervalInfo& lhs, const IntervalInfo& rhs)
+{
+    switch(op) {
+    case COMPARISON::LESS_THAN:
+        if(lhs.High < rhs.Low)
+            return TRI_STATE::True;
+        return lhs.Low >= rhs.High ? TRI_STATE::False : TRI_STATE::Unknown;
+    case COMPARISON::LESS_THAN_EQUAL:
+        if(lhs.High <= rhs.Low)
+            return TRI_STATE::True;
+        return lhs.Low > rhs.High ? TRI_STATE::False : TRI_STATE::Unknown;
+    case COMPARISON::GREATER_THAN: return CompareIntervals(COMPARISON::LESS_THAN, rhs, lhs);
+    case COMPARISON::GREATER_THAN_EQUAL:
+        return CompareIntervals(COMPARISON::LESS_THAN_EQUAL, rhs, lhs);
+    case COMPARISON::EQUAL:
+        if(lhs.High < rhs.Low || rhs.High < lhs.Low)
+            return TRI_STATE::False;
+        return lhs.Low == lhs.High && lhs == rhs ? TRI_STATE::True : TRI_STATE::Unknown;
+    case COMPARISON::NOT_EQUAL:
+        return KleeneNot(CompareIntervals(COMPARISON::EQUAL, lhs, rhs));
+    }
+
+    throw std::runtime_error("this should be unreachable");
+}
+
+//! \brief Applies an operator to all values of the intervals
+//! \returns Unknown if the result can wrap around as then it could have any value
+VariableState ApplyIntervalOperator(
+    OPERATOR op, const VariableState& lhs, const VariableState& rhs)
+{
+    const auto first = lhs.GetBounds();
+    const auto second = rhs.GetBounds();
+
+    if(!first || !second)
+        return VariableState();
+
+    const auto type = CommonType(first->Type, second->Type);
+
+    if(!IntervalInfo::IsSupported(type))
+        return VariableState();
+
+    // The bounds are 64 bit so these can't overflow. Negative values converted to an
+    // unsigned type give the same result modulo its range, so a result that is in the range
+    // of type is the C result
+    SignedWide low;
+    SignedWide high;
+
+    switch(op) {
+    case OPERATOR::Add:
+        low = static_cast<SignedWide>(first->Low) + second->Low;
+        high = static_cast<SignedWide>(first->High) + second->High;
+        break;
+    case OPERATOR::Subtract:
+        low = static_cast<SignedWide>(first->Low) - second->High;
+        high = static_cast<SignedWide>(first->High) - second->Low;
+        break;
+    case OPERATOR::Multiply: {
+        const SignedWide products[] = {static_cast<SignedWide>(first->Low) * second->Low,
+            static_cast<SignedWide>(first->Low) * second->High,
+            static_cast<SignedWide>(first->High) * second->Low,
+            static_cast<SignedWide>(first->High) * second->High};
+
+        low = *std::min_element(std::begin(products), std::end(products));
+        high = *std::max_element(std::begin(products), std::end(products));
+        break;
+    }
+    default: return VariableState();
+    }
+
+    const auto limits = IntervalInfo::Full(type);
+
+    if(!Contains(limits, low) || !Contains(limits, high))
+        return VariableState();
+
+    return VariableState(
+        IntervalInfo(type, static_cast<int64_t>(low), static_cast<int64_t>(high)));
+}
+
+} // namespace
+// ------------------------------------ //
 // VariableIdentifier
+VariableIdentifier::VariableIdentifier(const std::string& name) :
+    ID(SymbolTable::Get().Intern(name))
+{}
+
 VariableIdentifier::VariableIdentifier(clang::VarDecl* var) :
-    Name(var->getQualifiedNameAsString())
+    ID(SymbolTable::Get().Intern(var))
+{}
+
+std::string VariableIdentifier::Dump() const
 {
-    // var->getGlobalID();
+    return SymbolTable::Get().GetName(ID);
 }
 // ------------------------------------ //
 // BufferInfo
@@ -33,162 +146,198 @@ BufferInfo BufferInfo::ApplyOperator(OPERATOR op, const BufferInfo& other) const
     }
 }
 // ------------------------------------ //
-// PrimitiveInfo
-bool PrimitiveInfo::IsNonZero() const
-{
-    if(auto var = std::get_if<bool>(&Value); var) {
-        return *var;
-    } else if(auto var = std::get_if<Integer>(&Value); var) {
-        return (*var) != 0;
-    } else if(auto var = std::get_if<double>(&Value); var) {
-        return (*var) != 0;
-    } else {
-        throw std::runtime_error("unhandled variant in PrimitiveInfo");
-    }
-}
-
-PrimitiveInfo::Integer PrimitiveInfo::AsInteger() const
+// IntervalInfo
+bool IntervalInfo::IsSupported(PRIMITIVE_TYPE type)
 {
-    if(auto var = std::get_if<bool>(&Value); var) {
-        return *var;
-    } else if(auto var = std::get_if<Integer>(&Value); var) {
-        return *var;
-    } else if(auto var = std::get_if<double>(&Value); var) {
-        return *var;
-    } else {
-        throw std::runtime_error("unhandled variant in PrimitiveInfo");
-    }
+    if(type == PRIMITIVE_TYPE::Double)
+        return false;
+
+    return BitWidth(type) <= (IsSigned(type) ? 64 : 32);
 }
 
-bool PrimitiveInfo::CompareTo(COMPARISON op, const PrimitiveInfo& other) const
+IntervalInfo IntervalInfo::Full(PRIMITIVE_TYPE type)
 {
-    // Direct operator calls work here
-    if(Value.index() == other.Value.index()) {
-        switch(op) {
-        case COMPARISON::LESS_THAN: return Value < other.Value;
-        case COMPARISON::LESS_THAN_EQUAL: return Value <= other.Value;
-        case COMPARISON::GREATER_THAN: return Value > other.Value;
-        case COMPARISON::GREATER_THAN_EQUAL: return Value >= other.Value;
-        case COMPARISON::NOT_EQUAL: return Value != other.Value;
-        case COMPARISON::EQUAL: return Value == other.Value;
-        }
+    if(!IsSupported(type))
+        throw std::invalid_argument("type doesn't have intervals");
 
-        throw std::runtime_error("unhandled COMPARISON in PrimitiveInfo");
-    }
+    const auto width = BitWidth(type);
 
-    // A really basic comparison which loses information
-    const auto first = AsInteger();
-    const auto second = other.AsInteger();
+    if(!IsSigned(type))
+        return IntervalInfo(type, 0, static_cast<int64_t>((uint64_t(1) << width) - 1));
 
-    switch(op) {
-    case COMPARISON::LESS_THAN: return first < second;
-    case COMPARISON::LESS_THAN_EQUAL: return first <= second;
-    case COMPARISON::GREATER_THAN: return first > second;
-    case COMPARISON::GREATER_THAN_EQUAL: return first >= second;
-    case COMPARISON::NOT_EQUAL: return first != second;
-    case COMPARISON::EQUAL: return first == second;
-    }
+    const auto max = static_cast<int64_t>((uint64_t(1) << (width - 1)) - 1);
+    return IntervalInfo(type, -max - 1, max);
+}
 
-    throw std::runtime_error("unhandled COMPARISON in PrimitiveInfo");
+std::string IntervalInfo::Dump() const
+{
+    return "[" + std::to_string(Low) + ", " + std::to_string(High) + "]";
 }
 // ------------------------------------ //
-template<class T>
-std::optional<PrimitiveInfo> ApplyHelperOne(
-    OPERATOR op, const PrimitiveInfo& first, const PrimitiveInfo& second)
-{
-    if(auto val = std::get_if<T>(&first.Value); val) {
-        const auto otherVal = std::get<T>(second.Value);
-        switch(op) {
-        case OPERATOR::Add: return *val + otherVal;
-        case OPERATOR::Multiply: return *val * otherVal;
-        case OPERATOR::Subtract: return *val - otherVal;
-        }
+// VarCopyInfo
+std::string VarCopyInfo::Dump() const
+{
+    return "assign from " + Source.Dump();
+}
+// ------------------------------------ //
+// ComputeInfo
+std::string ComputeInfo::Dump() const
+{
+    return LHS.Dump() + " " + ::Dump(Operation) + " " + RHS.Dump();
+}
+// ------------------------------------ //
+// VariableState
+VariableState::VariableState(const ComputeInfo& compute)
+{
+    Set(compute);
+}
+// ------------------------------------ //
+void VariableState::Set(BufferInfo buffer)
+{
+    *this = VariableState();
+    State = STATE::Buffer;
+    Kind = buffer.NullPtr ? 1 : 0;
+    Payload = buffer.AllocatedSize;
+}
 
-        throw std::runtime_error("unhandled OPERATOR in PrimitiveInfo");
-    }
+void VariableState::Set(VarCopyInfo copyInfo)
+{
+    *this = VariableState();
+    State = STATE::CopyVar;
+    Reference = copyInfo.Source.ID;
+}
 
-    return std::optional<PrimitiveInfo>{};
+void VariableState::Set(PrimitiveInfo primitive)
+{
+    *this = VariableState();
+    State = STATE::Primitive;
+    Kind = static_cast<uint8_t>(primitive.Type);
+    Payload = static_cast<uint64_t>(primitive.Bits);
+
+    // Values are stored inline when extending the low bits gives back the full value
+    if(GetPrimitive() != primitive)
+        Reference = ConstantPool::Get().Intern(primitive.Bits) + 1;
 }
 
-template<class T, class... Extra>
-PrimitiveInfo ApplyHelper(OPERATOR op, const PrimitiveInfo& first, const PrimitiveInfo& second)
+void VariableState::Set(IntervalInfo interval)
 {
-    auto current = ApplyHelperOne<T>(op, first, second);
+    if(interval.Low > interval.High)
+        throw std::invalid_argument("interval low bound is over its high bound");
+
+    if(interval.Low == interval.High) {
+        Set(PrimitiveInfo(interval.Type,
+            static_cast<PrimitiveInfo::WideBits>(static_cast<SignedWide>(interval.Low))));
+        return;
+    }
 
-    if(current)
-        return *current;
+    *this = VariableState();
+    State = STATE::Range;
+    Kind = static_cast<uint8_t>(interval.Type);
 
-    if constexpr(sizeof...(Extra) > 0) {
-        return ApplyHelper<Extra...>(op, first, second);
+    if(FitsInt32(interval.Low) && FitsInt32(interval.High)) {
+        Payload = static_cast<uint64_t>(static_cast<uint32_t>(interval.Low)) |
+                  (static_cast<uint64_t>(static_cast<uint32_t>(interval.High)) << 32);
     } else {
-        throw std::runtime_error("template expansion reached end, this shouldn't happen");
+        Reference = ConstantPool::Get().Intern(
+                        (static_cast<PrimitiveInfo::WideBits>(
+                             static_cast<uint64_t>(interval.High))
+                            << 64) |
+                        static_cast<uint64_t>(interval.Low)) +
+                    1;
     }
 }
 
-PrimitiveInfo PrimitiveInfo::ApplyOperator(OPERATOR op, const PrimitiveInfo& other) const
+void VariableState::Set(const ComputeInfo& compute)
 {
-    if(Value.index() == other.Value.index()) {
+    const auto id = ExpressionArena::Get().Intern(compute);
 
-        return ApplyHelper<bool, Integer, double>(op, *this, other);
-    }
+    *this = VariableState();
+    State = STATE::Compute;
+    Reference = id;
+}
+// ------------------------------------ //
+PrimitiveInfo VariableState::GetPrimitive() const
+{
+    const auto type = static_cast<PRIMITIVE_TYPE>(Kind);
 
-    // A really basic operator which loses information
-    const auto first = AsInteger();
-    const auto second = other.AsInteger();
+    if(Reference != 0)
+        return PrimitiveInfo(type, ConstantPool::Get().GetConstant(Reference - 1));
 
-    switch(op) {
-    case OPERATOR::Add: return first + second;
-    case OPERATOR::Multiply: return first * second;
-    case OPERATOR::Subtract: return first - second;
-    }
+    // Only 128 bit types need extending, the others are truncated back to their width
+    if(IsSigned(type))
+        return PrimitiveInfo(type,
+            static_cast<PrimitiveInfo::WideBits>(static_cast<__int128>(
+                static_cast<int64_t>(Payload))));
 
-    throw std::runtime_error("unhandled COMPARISON in PrimitiveInfo");
+    return PrimitiveInfo(type, Payload);
 }
-// ------------------------------------ //
-std::string PrimitiveInfo::Dump() const
-{
-    if(auto var = std::get_if<bool>(&Value); var) {
-        if(*var == true)
-            return "true";
-        return "false";
-    } else if(auto var = std::get_if<Integer>(&Value); var) {
-        return std::to_string(*var);
-    } else if(auto var = std::get_if<double>(&Value); var) {
-        return std::to_string(*var);
-    } else {
-        return "ERROR: unhandled variant type";
+
+IntervalInfo VariableState::GetInterval() const
+{
+    const auto type = static_cast<PRIMITIVE_TYPE>(Kind);
+
+    if(Reference != 0) {
+        const auto bits = ConstantPool::Get().GetConstant(Reference - 1);
+        return IntervalInfo(type, static_cast<int64_t>(static_cast<uint64_t>(bits)),
+            static_cast<int64_t>(static_cast<uint64_t>(bits >> 64)));
     }
+
+    return IntervalInfo(type, static_cast<int32_t>(static_cast<uint32_t>(Payload)),
+        static_cast<int32_t>(static_cast<uint32_t>(Payload >> 32)));
 }
-// ------------------------------------ //
-// VarCopyInfo
-std::string VarCopyInfo::Dump() const
+
+std::optional<IntervalInfo> VariableState::GetBounds() const
 {
-    return "assign from " + Source.Dump();
+    if(State == STATE::Range)
+        return GetInterval();
+
+    const auto type = static_cast<PRIMITIVE_TYPE>(Kind);
+
+    if(State != STATE::Primitive || !IntervalInfo::IsSupported(type))
+        return std::nullopt;
+
+    const auto value = static_cast<int64_t>(GetPrimitive().AsSignedWide());
+    return IntervalInfo(type, value, value);
+}
+
+BufferInfo VariableState::GetBuffer() const
+{
+    if(Kind != 0)
+        return BufferInfo(nullptr);
+
+    return BufferInfo(static_cast<size_t>(Payload));
+}
+
+ComputeInfo VariableState::GetCompute() const
+{
+    return ExpressionArena::Get().GetExpression(Reference);
 }
 // ------------------------------------ //
-// ComputeInfo
-ComputeInfo::ComputeInfo(const VariableState& lhs, OPERATOR op, const VariableState& rhs) :
-    Operation(op), LHS(std::make_shared<VariableState>(lhs)),
-    RHS(std::make_shared<VariableState>(rhs))
-{}
-// ------------------------------------ //
-std::string ComputeInfo::Dump() const
+void VariableState::CollectVariables(std::vector<VariableIdentifier>& variables) const
 {
-    return LHS->Dump() + " " + ::Dump(Operation) + " " + RHS->Dump();
+    switch(State) {
+    case STATE::CopyVar: variables.push_back(GetCopy().Source); break;
+    case STATE::Compute: {
+        const auto& compute = ExpressionArena::Get().GetExpression(Reference);
+        compute.LHS.CollectVariables(variables);
+        compute.RHS.CollectVariables(variables);
+        break;
+    }
+    default: break;
+    }
 }
 // ------------------------------------ //
-// VariableState
-int VariableState::ToZeroOrNonZero() const
+TRI_STATE VariableState::IsNonZero() const
 {
     switch(State) {
+    case STATE::Primitive: return ToTriState(GetPrimitive().IsNonZero());
+    case STATE::Buffer: return ToTriState(Kind == 0);
+    case STATE::Range:
+        return Contains(GetInterval(), 0) ? TRI_STATE::Unknown : TRI_STATE::True;
+    // Copies and computations need to be resolved first
     case STATE::Unknown:
-        throw UnknownVariableStateException("unknown variable in VariableState");
-    case STATE::Primitive: return std::get<PrimitiveInfo>(Value).IsNonZero() ? 1 : 0;
-    case STATE::Buffer: return std::get<BufferInfo>(Value).NullPtr ? 0 : 1;
     case STATE::Compute:
-    case STATE::CopyVar:
-        throw UnknownVariableStateException(
-            "copyvar must be resolved before call to ToZeroOrNonZero");
+    case STATE::CopyVar: return TRI_STATE::Unknown;
     }
 
     throw std::runtime_error("this should be unreachable");
@@ -204,12 +353,11 @@ VariableState VariableState::ResolveValue(
 {
     while(variable.State == STATE::CopyVar) {
 
-        variable =
-            otherVariables.GetVariableValueRaw(std::get<VarCopyInfo>(variable.Value).Source);
+        variable = otherVariables.GetVariableValueRaw(variable.GetCopy().Source);
     }
 
     if(variable.State == STATE::Compute) {
-        variable = PerformComputation(std::get<ComputeInfo>(variable.Value), otherVariables);
+        variable = PerformComputation(variable.GetCompute(), otherVariables);
     }
 
     return variable;
@@ -227,13 +375,26 @@ bool VariableState::CompareTo(COMPARISON op, const VariableState& other) const
 
     switch(State) {
     case STATE::Primitive:
-        return std::get<PrimitiveInfo>(Value).CompareTo(
-            op, std::get<PrimitiveInfo>(other.Value));
+        return GetPrimitive().CompareTo(op, other.GetPrimitive());
         // These don't store enough info to be comparable
     // case STATE::Buffer: return std::get<BufferInfo>(Value).Dump();
     default: return false;
     }
 }
+
+TRI_STATE VariableState::Compare(COMPARISON op, const VariableState& other) const
+{
+    if(State != STATE::Range && other.State != STATE::Range)
+        return ToTriState(CompareTo(op, other));
+
+    const auto lhs = GetBounds();
+    const auto rhs = other.GetBounds();
+
+    if(!lhs || !rhs || !HaveCompatibleSigns(*lhs, *rhs))
+        return TRI_STATE::Unknown;
+
+    return CompareIntervals(op, *lhs, *rhs);
+}
 // ------------------------------------ //
 VariableState VariableState::CreateOperatorApplyingState(
     OPERATOR op, const VariableState& other) const
@@ -247,12 +408,15 @@ VariableState VariableState::CreateOperatorApplyingState(
 VariableState VariableState::PerformComputation(
     const ComputeInfo& computation, const VariableValueProvider& otherVariables)
 {
-    const auto lhs = computation.LHS->Resolve(otherVariables);
-    const auto rhs = computation.RHS->Resolve(otherVariables);
+    const auto lhs = computation.LHS.Resolve(otherVariables);
+    const auto rhs = computation.RHS.Resolve(otherVariables);
 
     if(lhs.State == STATE::Unknown || rhs.State == STATE::Unknown)
         return VariableState();
 
+    if(lhs.State == STATE::Range || rhs.State == STATE::Range)
+        return ApplyIntervalOperator(computation.Operation, lhs, rhs);
+
     // TODO: some different states could probably be applied an operator to. Like
     // Buffer and 1
     if(lhs.State != rhs.State)
@@ -260,27 +424,61 @@ VariableState VariableState::PerformComputation(
 
     switch(lhs.State) {
     case STATE::Primitive:
-        return std::get<PrimitiveInfo>(lhs.Value).ApplyOperator(
-            computation.Operation, std::get<PrimitiveInfo>(rhs.Value));
+        return lhs.GetPrimitive().ApplyOperator(computation.Operation, rhs.GetPrimitive());
     case STATE::Buffer:
-        return std::get<BufferInfo>(lhs.Value).ApplyOperator(
-            computation.Operation, std::get<BufferInfo>(rhs.Value));
+        return lhs.GetBuffer().ApplyOperator(computation.Operation, rhs.GetBuffer());
+    // Resolving should have removed these
     case STATE::Compute:
-    case STATE::CopyVar:
-        throw UnknownVariableStateException(
-            "copyvar / recursive compute should have been solved (PerformComputation)");
+    case STATE::CopyVar: return VariableState();
     default: throw std::runtime_error("this should be unreachable");
     }
 }
 // ------------------------------------ //
+VariableState VariableState::Join(const VariableState& lhs, const VariableState& rhs)
+{
+    if(lhs == rhs)
+        return lhs;
+
+    const auto first = lhs.GetBounds();
+    const auto second = rhs.GetBounds();
+
+    if(!first || !second || first->Type != second->Type)
+        return VariableState();
+
+    return VariableState(IntervalInfo(first->Type, std::min(first->Low, second->Low),
+        std::max(first->High, second->High)));
+}
+
+VariableState VariableState::Widen(const VariableState& previous, const VariableState& next)
+{
+    const auto joined = Join(previous, next);
+
+    if(joined == previous || joined.State != STATE::Range)
+        return joined;
+
+    // Each bound moves to the limit at most once so widening the same state again ends
+    const auto before = *previous.GetBounds();
+    const auto limits = IntervalInfo::Full(before.Type);
+    auto bounds = joined.GetInterval();
+
+    if(bounds.Low < before.Low)
+        bounds.Low = limits.Low;
+
+    if(bounds.High > before.High)
+        bounds.High = limits.High;
+
+    return VariableState(bounds);
+}
+// ------------------------------------ //
 std::string VariableState::Dump() const
 {
     switch(State) {
     case STATE::Unknown: return "unknown";
     case STATE::Primitive:
     case STATE::Buffer:
-    case STATE::CopyVar: return DumpValue();
-    case STATE::Compute: return "(compute " + std::get<ComputeInfo>(Value).Dump() + ")";
+    case STATE::CopyVar:
+    case STATE::Range: return DumpValue();
+    case STATE::Compute: return "(compute " + GetCompute().Dump() + ")";
     }
 
     throw std::runtime_error("VariableState is in invalid state");
@@ -288,27 +486,76 @@ std::string VariableState::Dump() const
 
 std::string VariableState::DumpValue() const
 {
-    if(auto value = std::get_if<PrimitiveInfo>(&Value); value) {
-        return value->Dump();
-    } else if(auto value = std::get_if<BufferInfo>(&Value); value) {
-        return value->Dump();
-    } else if(auto value = std::get_if<VarCopyInfo>(&Value); value) {
-        return value->Dump();
-    } else {
-        throw std::runtime_error("VariableState Value has unprintable type");
+    switch(State) {
+    case STATE::Primitive: return GetPrimitive().Dump();
+    case STATE::Buffer: return GetBuffer().Dump();
+    case STATE::CopyVar: return GetCopy().Dump();
+    case STATE::Range: return GetInterval().Dump();
+    default: throw std::runtime_error("VariableState Value has unprintable type");
     }
 }
 // ------------------------------------ //
 // ValueRange
-bool ValueRange::Matches(
+ValueRange::ValueRange(RANGE_CLASS type, std::vector<SetValue> values) :
+    Type(type), Values(std::move(values))
+{
+    if(Type != RANGE_CLASS::InSet && Type != RANGE_CLASS::NotInSet)
+        throw std::invalid_argument("ValueRange with values needs to be InSet or NotInSet");
+
+    std::sort(Values.begin(), Values.end());
+    Values.erase(std::unique(Values.begin(), Values.end()), Values.end());
+}
+// ------------------------------------ //
+TRI_STATE ValueRange::Matches(
     const VariableState& state, const VariableValueProvider& otherVariables) const
 {
+    if(state.State == VariableState::STATE::Unknown)
+        return TRI_STATE::Unknown;
+
     switch(Type) {
-    case RANGE_CLASS::NotZero: return state.ToZeroOrNonZero() != 0;
-    case RANGE_CLASS::Zero: return state.ToZeroOrNonZero() == 0;
-    case RANGE_CLASS::Comparison:
-        return state.CompareTo(Comparison, otherVariables.GetVariableValue(*ComparedTo));
-    case RANGE_CLASS::Constant: return state.CompareTo(Comparison, *ComparedConstant);
+    case RANGE_CLASS::NotZero: return state.IsNonZero();
+    case RANGE_CLASS::Zero: return KleeneNot(state.IsNonZero());
+    case RANGE_CLASS::Comparison: {
+        const auto other = otherVariables.GetVariableValue(*ComparedTo);
+
+        if(other.State == VariableState::STATE::Unknown)
+            return TRI_STATE::Unknown;
+
+        return state.Compare(Comparison, other);
+    }
+    case RANGE_CLASS::Constant:
+        if(ComparedConstant->State == VariableState::STATE::Unknown)
+            return TRI_STATE::Unknown;
+
+        return state.Compare(Comparison, *ComparedConstant);
+    case RANGE_CLASS::InSet:
+    case RANGE_CLASS::NotInSet: {
+        if(state.State == VariableState::STATE::Range) {
+            const auto interval = state.GetInterval();
+            const auto first = std::lower_bound(Values.begin(), Values.end(), interval.Low);
+            const auto last = std::upper_bound(first, Values.end(), interval.High);
+
+            // The values are unique so the set covers the interval if it has as many values
+            const SignedWide count = last - first;
+            const auto inSet = count == 0 ? TRI_STATE::False :
+                               count == static_cast<SignedWide>(interval.High) -
+                                            interval.Low + 1 ?
+                                               TRI_STATE::True :
+                                               TRI_STATE::Unknown;
+
+            return Type == RANGE_CLASS::InSet ? inSet : KleeneNot(inSet);
+        }
+
+
+        // Like with comparisons other kinds of values don't match either way
+        if(state.State != VariableState::STATE::Primitive)
+            return TRI_STATE::False;
+
+        const bool found = std::binary_search(
+            Values.begin(), Values.end(), state.GetPrimitive().AsSignedWide());
+
+        return ToTriState(Type == RANGE_CLASS::InSet ? found : !found);
+    }
     }
 
     throw std::runtime_error("this should be unreachable");
@@ -321,11 +568,105 @@ ValueRange ValueRange::Negate() const
     case RANGE_CLASS::Zero: return ValueRange(RANGE_CLASS::NotZero);
     case RANGE_CLASS::Comparison: return ValueRange(::Negate(Comparison), *ComparedTo);
     case RANGE_CLASS::Constant: return ValueRange(::Negate(Comparison), *ComparedConstant);
+    case RANGE_CLASS::InSet: return ValueRange(RANGE_CLASS::NotInSet, Values);
+    case RANGE_CLASS::NotInSet: return ValueRange(RANGE_CLASS::InSet, Values);
     }
 
     throw std::runtime_error("negate not implemented for this ValueRange type");
 }
 
+std::optional<VariableState> ValueRange::Refine(
+    const VariableState& current, const VariableValueProvider& otherVariables) const
+{
+    // Everything is turned into a comparison against bound
+    COMPARISON op = Comparison;
+    VariableState bound;
+
+    switch(Type) {
+    case RANGE_CLASS::NotZero:
+    case RANGE_CLASS::Zero:
+        op = Type == RANGE_CLASS::Zero ? COMPARISON::EQUAL : COMPARISON::NOT_EQUAL;
+        bound = VariableState(PrimitiveInfo(0));
+        break;
+    case RANGE_CLASS::Comparison: bound = otherVariables.GetVariableValue(*ComparedTo); break;
+    case RANGE_CLASS::Constant: bound = ComparedConstant->Resolve(otherVariables); break;
+    case RANGE_CLASS::InSet: {
+        // Only the smallest and largest value are used
+        const SignedWide low = std::max<SignedWide>(Values.front(), INT64_MIN);
+        const SignedWide high = std::min<SignedWide>(Values.back(), INT64_MAX);
+
+        if(low > high)
+            return std::nullopt;
+
+        op = COMPARISON::EQUAL;
+        bound = VariableState(IntervalInfo(PRIMITIVE_TYPE::Int64, static_cast<int64_t>(low),
+            static_cast<int64_t>(high)));
+        break;
+    }
+    case RANGE_CLASS::NotInSet: return std::nullopt;
+    }
+
+    // Comparing to an unknown variable doesn't tell anything
+    if(bound.State == VariableState::STATE::Unknown)
+        return std::nullopt;
+
+    const auto limit = bound.GetBounds();
+    auto bounds = current.GetBounds();
+
+    // An unknown variable is assumed to have the type it is compared to
+    if(!bounds && current.State == VariableState::STATE::Unknown && limit)
+        bounds = IntervalInfo::Full(limit->Type);
+
+    if(!bounds || !limit || !HaveCompatibleSigns(*bounds, *limit)) {
+
+        // Without intervals only an exact value can be assumed
+        if(op == COMPARISON::EQUAL && bound.State != VariableState::STATE::Range)
+            return bound;
+
+        return std::nullopt;
+    }
+
+    SignedWide low = bounds->Low;
+    SignedWide high = bounds->High;
+    const SignedWide limitLow = limit->Low;
+    const SignedWide limitHigh = limit->High;
+
+    switch(op) {
+    case COMPARISON::LESS_THAN: high = std::min(high, limitHigh - 1); break;
+    case COMPARISON::LESS_THAN_EQUAL: high = std::min(high, limitHigh); break;
+    case COMPARISON::GREATER_THAN: low = std::max(low, limitLow + 1); break;
+    case COMPARISON::GREATER_THAN_EQUAL: low = std::max(low, limitLow); break;
+    case COMPARISON::EQUAL:
+        low = std::max(low, limitLow);
+        high = std::min(high, limitHigh);
+        break;
+    case COMPARISON::NOT_EQUAL:
+        // Only a single value at either end can be removed from an interval
+        if(limitLow == limitHigh) {
+            if(low == limitLow)
+                ++low;
+            if(high == limitLow)
+                --high;
+        }
+        break;
+    }
+
+    if(low > high || (low == bounds->Low && high == bounds->High))
+        return std::nullopt;
+
+    return VariableState(
+        IntervalInfo(bounds->Type, static_cast<int64_t>(low), static_cast<int64_t>(high)));
+}
+
+void ValueRange::CollectVariables(std::vector<VariableIdentifier>& variables) const
+{
+    if(ComparedTo)
+        variables.push_back(*ComparedTo);
+
+    if(ComparedConstant)
+        ComparedConstant->CollectVariables(variables);
+}
+
 std::string ValueRange::Dump() const
 {
     switch(Type) {
@@ -335,6 +676,20 @@ std::string ValueRange::Dump() const
         return ::Dump(Comparison) + std::string(" ") + ComparedTo->Dump();
     case RANGE_CLASS::Constant:
         return ::Dump(Comparison) + std::string(" ") + ComparedConstant->Dump();
+    case RANGE_CLASS::InSet:
+    case RANGE_CLASS::NotInSet: {
+        std::string result = Type == RANGE_CLASS::InSet ? "in {" : "not in {";
+
+        for(size_t i = 0; i < Values.size(); ++i) {
+            if(i != 0)
+                result += ", ";
+            result += PrimitiveInfo(PRIMITIVE_TYPE::Int128,
+                static_cast<PrimitiveInfo::WideBits>(Values[i]))
+                          .Dump();
+        }
+
+        return result + "}";
+    }
     default: return "== ?";
     }
 }
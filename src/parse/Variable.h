@@ -1,48 +1,45 @@
 #pragma once
 
+#include "Hashing.h"
+#include "Primitive.h"
+#include "SymbolTable.h"
+
 #include "rotate.h"
 
 #include <clang/AST/Stmt.h>
 
 #include <cstdint>
 #include <string>
-#include <variant>
+#include <type_traits>
+#include <vector>
 
 namespace smacpp {
 
 class VariableValueProvider;
 class VariableState;
 
-//! \todo The values inside should be renamed to match naming convention
-enum class COMPARISON {
-    LESS_THAN,
-    LESS_THAN_EQUAL,
-    GREATER_THAN,
-    GREATER_THAN_EQUAL,
-    NOT_EQUAL,
-    EQUAL
-};
-
-enum class OPERATOR { Add, Multiply, Subtract };
-
 
+//! \brief Refers to a variable through its interned SymbolTable id
 struct VariableIdentifier {
-    VariableIdentifier(const std::string& name) : Name(name) {}
+    explicit VariableIdentifier(SymbolTable::SymbolID id) : ID(id) {}
+
+    VariableIdentifier(const std::string& name);
 
     VariableIdentifier(clang::VarDecl* var);
 
-    std::string Dump() const
+    std::string Dump() const;
+
+    bool operator==(const VariableIdentifier& other) const
     {
-        return Name;
+        return ID == other.ID;
     }
 
-    bool operator==(const VariableIdentifier& other) const
+    bool operator!=(const VariableIdentifier& other) const
     {
-        return Name == other.Name;
+        return ID != other.ID;
     }
 
-    //! \todo Implement proper scoping
-    std::string Name;
+    SymbolTable::SymbolID ID;
 };
 
 struct BufferInfo {
@@ -65,26 +62,33 @@ public:
     size_t AllocatedSize = 0;
 };
 
-struct PrimitiveInfo {
-public:
-    using Integer = long long;
+//! \brief Integer values from Low to High inclusive
+//!
+//! Only types whose values all fit in a 64 bit signed integer have intervals so the bounds
+//! are the mathematical values. This is used when a variable can have a range of values,
+//! for example an index that was checked to be below some limit
+struct IntervalInfo {
+    IntervalInfo(PRIMITIVE_TYPE type, int64_t low, int64_t high) :
+        Type(type), Low(low), High(high)
+    {}
 
-    PrimitiveInfo(Integer intValue) : Value(intValue) {}
+    //! \returns True if the values of type fit in the bounds
+    static bool IsSupported(PRIMITIVE_TYPE type);
 
-    bool IsNonZero() const;
-    Integer AsInteger() const;
+    //! \returns The interval of all values of type
+    //! \pre IsSupported(type)
+    static IntervalInfo Full(PRIMITIVE_TYPE type);
 
     std::string Dump() const;
 
-    bool CompareTo(COMPARISON op, const PrimitiveInfo& other) const;
-    PrimitiveInfo ApplyOperator(OPERATOR op, const PrimitiveInfo& other) const;
-
-    bool operator==(const PrimitiveInfo& other) const
+    bool operator==(const IntervalInfo& other) const
     {
-        return Value == other.Value;
+        return Type == other.Type && Low == other.Low && High == other.High;
     }
 
-    std::variant<bool, Integer, double> Value;
+    PRIMITIVE_TYPE Type;
+    int64_t Low;
+    int64_t High;
 };
 
 struct VarCopyInfo {
@@ -100,34 +104,49 @@ struct VarCopyInfo {
     VariableIdentifier Source;
 };
 
-struct ComputeInfo {
-    ComputeInfo(const VariableState& lhs, OPERATOR op, const VariableState& rhs);
+struct ComputeInfo;
 
-    std::string Dump() const;
-
-    bool operator==(const ComputeInfo& other) const
-    {
-        return Operation == other.Operation && LHS == other.LHS && RHS == other.RHS;
-    }
+//! \brief Three valued (Kleene) truth value, Unknown is the result when the variable values
+//! needed to decide aren't known
+//!
+//! The values are ordered so that and is the minimum and or is the maximum of the operands
+enum class TRI_STATE : uint8_t { False, Unknown, True };
 
-    OPERATOR Operation;
-    std::shared_ptr<VariableState> LHS;
-    std::shared_ptr<VariableState> RHS;
-};
+constexpr TRI_STATE ToTriState(bool value)
+{
+    return value ? TRI_STATE::True : TRI_STATE::False;
+}
 
-class UnknownVariableStateException : public std::runtime_error {
-public:
-    UnknownVariableStateException(const char* what) : std::runtime_error(what) {}
-};
+constexpr TRI_STATE KleeneNot(TRI_STATE value)
+{
+    return static_cast<TRI_STATE>(2 - static_cast<uint8_t>(value));
+}
 
+constexpr TRI_STATE KleeneAnd(TRI_STATE lhs, TRI_STATE rhs)
+{
+    return lhs < rhs ? lhs : rhs;
+}
 
+constexpr TRI_STATE KleeneOr(TRI_STATE lhs, TRI_STATE rhs)
+{
+    return lhs < rhs ? rhs : lhs;
+}
 
+//! \brief Tagged 16 byte value of a variable
+//!
+//! This is trivially copyable so that program states and call parameter lists can be
+//! copied and hashed cheaply. Integers and buffer sizes are stored inline, copies refer to
+//! a SymbolTable id and computations to an ExpressionArena id. 128 bit values that don't fit
+//! in 64 bits are stored in the ConstantPool, as are intervals whose bounds don't both fit in
+//! 32 bits
 class VariableState {
 public:
-    enum class STATE { Unknown, Primitive, Buffer, CopyVar, Compute };
+    enum class STATE : uint8_t { Unknown, Primitive, Buffer, CopyVar, Compute, Range };
+
+    using ExpressionID = uint32_t;
 
 public:
-    VariableState() {}
+    VariableState() = default;
 
     VariableState(const BufferInfo& data)
     {
@@ -144,72 +163,100 @@ public:
         Set(data);
     }
 
-    VariableState(const ComputeInfo& compute)
+    VariableState(const IntervalInfo& data)
     {
-        Set(compute);
+        Set(data);
     }
 
-    VariableState(const VariableState& other) : State(other.State), Value(other.Value) {}
-    VariableState(VariableState&& other) noexcept :
-        State(other.State), Value(std::move(other.Value))
-    {}
+    VariableState(const ComputeInfo& compute);
 
     //! Sets from a buffer
-    void Set(BufferInfo buffer)
-    {
-        State = STATE::Buffer;
-        Value = buffer;
-    }
+    void Set(BufferInfo buffer);
 
     //! Copied from another var
-    void Set(VarCopyInfo copyInfo)
-    {
-        State = STATE::CopyVar;
-        Value = copyInfo;
-    }
+    void Set(VarCopyInfo copyInfo);
 
     //! Sets from a known primitive value
-    void Set(PrimitiveInfo primitive)
+    void Set(PrimitiveInfo primitive);
+
+    void Set(const ComputeInfo& compute);
+
+    //! Sets from an interval, an interval of a single value is stored as a primitive
+    //! \pre interval.Low <= interval.High
+    void Set(IntervalInfo interval);
+
+    //! \pre State == STATE::Primitive
+    PrimitiveInfo GetPrimitive() const;
+
+    //! \pre State == STATE::Buffer
+    BufferInfo GetBuffer() const;
+
+    //! \pre State == STATE::Range
+    IntervalInfo GetInterval() const;
+
+    //! \returns The values this can have as an interval, empty if this isn't an integer or
+    //! an interval of a supported type
+    std::optional<IntervalInfo> GetBounds() const;
+
+    //! \pre State == STATE::CopyVar
+    VarCopyInfo GetCopy() const
     {
-        State = STATE::Primitive;
-        Value = primitive;
+        return VarCopyInfo(VariableIdentifier(Reference));
     }
 
-    void Set(ComputeInfo compute)
+    //! \pre State == STATE::Compute
+    ExpressionID GetExpressionID() const
     {
-        State = STATE::Compute;
-        Value = compute;
+        return Reference;
     }
 
+    //! \pre State == STATE::Compute
+    ComputeInfo GetCompute() const;
+
     //! \brief Resolves the actual value if this state is copied from a variable
     VariableState Resolve(const VariableValueProvider& otherVariables) const;
 
     //! \brief Compares this variable to another with an operator
     bool CompareTo(COMPARISON op, const VariableState& other) const;
 
+    //! \brief Compares like CompareTo but intervals can also be compared, Unknown is returned
+    //! when the intervals overlap so that both results are possible
+    TRI_STATE Compare(COMPARISON op, const VariableState& other) const;
+
     //! \brief Returns a new state that is either a fully computed one or which will compute a
     //! value when resolving
     //! \todo If this contains calculations that all use known values this could be resolved
     //! already
     VariableState CreateOperatorApplyingState(OPERATOR op, const VariableState& other) const;
 
-    //! \brief Converts this to a 0 or 1
-    //! \exception UnknownVariableStateException if unknown
-    int ToZeroOrNonZero() const;
+    //! \returns True if this is non-zero like in a C condition, Unknown if the value isn't
+    //! known
+    TRI_STATE IsNonZero() const;
+
+    //! \brief Adds the variables resolving this state reads to variables
+    void CollectVariables(std::vector<VariableIdentifier>& variables) const;
 
     std::string Dump() const;
     std::string DumpValue() const;
 
-    VariableState operator=(const VariableState& other)
+    bool operator==(const VariableState& other) const
     {
-        State = other.State;
-        Value = other.Value;
-        return *this;
+        return State == other.State && Kind == other.Kind && Reference == other.Reference &&
+               Payload == other.Payload;
     }
 
-    bool operator==(const VariableState& other) const
+    bool operator!=(const VariableState& other) const
     {
-        return State == other.State && Value == other.Value;
+        return !(*this == other);
+    }
+
+    std::size_t Hash() const
+    {
+        const uint64_t header = static_cast<uint64_t>(State) |
+                                (static_cast<uint64_t>(Kind) << 8) |
+                                (static_cast<uint64_t>(Reference) << 32);
+
+        return CombineHash(MixHash(header), MixHash(Payload));
     }
 
     static VariableState PerformComputation(
@@ -218,17 +265,67 @@ public:
     static VariableState ResolveValue(
         VariableState variable, const VariableValueProvider& otherVariables);
 
+    //! \returns A state that covers both lhs and rhs. Different integers of the same type
+    //! are joined into an interval, other different states into Unknown
+    static VariableState Join(const VariableState& lhs, const VariableState& rhs);
+
+    //! \brief Joins next into previous so that repeated widening stops growing
+    //!
+    //! A bound of previous that next goes past is moved to the limit of the type
+    static VariableState Widen(const VariableState& previous, const VariableState& next);
+
     STATE State = STATE::Unknown;
 
-    std::variant<std::monostate, BufferInfo, PrimitiveInfo, VarCopyInfo, ComputeInfo> Value;
+private:
+    //! For primitives and intervals the PRIMITIVE_TYPE, for buffers 1 if this is a nullptr
+    uint8_t Kind = 0;
+    uint16_t Reserved = 0;
+
+    //! Source variable SymbolID for CopyVar, ExpressionID for Compute. For primitives and
+    //! intervals 0 if the value is in Payload or the ConstantPool id + 1
+    uint32_t Reference = 0;
+
+    //! Bits of the primitive value, the buffer size or the 32 bit interval bounds with Low
+    //! in the low half
+    uint64_t Payload = 0;
+};
+
+static_assert(sizeof(VariableState) == 16, "VariableState should be 16 bytes");
+static_assert(std::is_trivially_copyable_v<VariableState>,
+    "VariableState needs to be trivially copyable");
+
+//! \brief A binary operation whose result is computed when the state is resolved
+//!
+//! The operands refer to nested computations by id so comparing and hashing this doesn't
+//! recurse
+struct ComputeInfo {
+    ComputeInfo(const VariableState& lhs, OPERATOR op, const VariableState& rhs) :
+        Operation(op), LHS(lhs), RHS(rhs)
+    {}
+
+    std::string Dump() const;
+
+    bool operator==(const ComputeInfo& other) const
+    {
+        return Operation == other.Operation && LHS == other.LHS && RHS == other.RHS;
+    }
+
+    OPERATOR Operation;
+    VariableState LHS;
+    VariableState RHS;
 };
 
 struct ValueRange {
 public:
-    enum class RANGE_CLASS { NotZero, Zero, Comparison, Constant };
+    enum class RANGE_CLASS { NotZero, Zero, Comparison, Constant, InSet, NotInSet };
+
+    using SetValue = PrimitiveInfo::SignedWide;
 
 public:
     ValueRange(RANGE_CLASS type) : Type(type) {}
+
+    //! \brief Creates an InSet or NotInSet range, used for switch cases
+    ValueRange(RANGE_CLASS type, std::vector<SetValue> values);
     ValueRange(COMPARISON op, VariableIdentifier other) :
         Type(RANGE_CLASS::Comparison), Comparison(op), ComparedTo(other)
     {}
@@ -239,16 +336,55 @@ public:
 
     ValueRange Negate() const;
 
-    //! \returns True if the provided variable state satisfies this range
-    bool Matches(
+    //! \brief Narrows current to the values that match this range
+    //! \returns The narrowed state or empty if nothing is known or no value matches, the
+    //! latter happens on paths that can't be taken
+    std::optional<VariableState> Refine(
+        const VariableState& current, const VariableValueProvider& otherVariables) const;
+
+    //! \brief Adds the variables matching against this range reads to variables
+    void CollectVariables(std::vector<VariableIdentifier>& variables) const;
+
+    //! \returns True if the provided variable state satisfies this range, Unknown if the
+    //! state or the value it is compared to isn't known
+    TRI_STATE Matches(
         const VariableState& state, const VariableValueProvider& otherVariables) const;
 
     std::string Dump() const;
 
+    bool operator==(const ValueRange& other) const
+    {
+        return Type == other.Type && Comparison == other.Comparison &&
+               ComparedTo == other.ComparedTo && ComparedConstant == other.ComparedConstant &&
+               Values == other.Values;
+    }
+
+    std::size_t Hash() const
+    {
+        std::size_t result = MixHash(
+            static_cast<uint64_t>(Type) | (static_cast<uint64_t>(Comparison) << 8));
+
+        if(ComparedTo)
+            result = CombineHash(result, MixHash(ComparedTo->ID));
+
+        if(ComparedConstant)
+            result = CombineHash(result, ComparedConstant->Hash());
+
+        for(const auto value : Values) {
+            result = CombineHash(result, MixHash(static_cast<uint64_t>(value)));
+            result = CombineHash(result, MixHash(static_cast<uint64_t>(value >> 64)));
+        }
+
+        return result;
+    }
+
     RANGE_CLASS Type;
-    COMPARISON Comparison;
+    COMPARISON Comparison = COMPARISON::EQUAL;
     std::optional<VariableIdentifier> ComparedTo;
     std::optional<VariableState> ComparedConstant;
+
+    //! Sorted unique values for InSet and NotInSet, a binary search is used to match
+    std::vector<SetValue> Values;
 };
 
 inline COMPARISON Negate(COMPARISON op)
@@ -295,7 +431,7 @@ template<>
 struct hash<smacpp::VariableIdentifier> {
     std::size_t operator()(const smacpp::VariableIdentifier& k) const
     {
-        return hash<std::string>()(k.Name);
+        return hash<smacpp::SymbolTable::SymbolID>()(k.ID);
     }
 };
 
@@ -303,7 +439,7 @@ template<>
 struct hash<smacpp::BufferInfo> {
     std::size_t operator()(const smacpp::BufferInfo& k) const
     {
-        return hash()(k.AllocatedSize) ^ (hash()(k.NullPtr) << 1);
+        return hash<size_t>()(k.AllocatedSize) ^ (hash<bool>()(k.NullPtr) << 1);
     }
 };
 
@@ -311,7 +447,7 @@ template<>
 struct hash<smacpp::PrimitiveInfo> {
     std::size_t operator()(const smacpp::PrimitiveInfo& k) const
     {
-        return hash<std::variant<bool, smacpp::PrimitiveInfo::Integer, double>>()(k.Value);
+        return k.Hash();
     }
 };
 
@@ -323,27 +459,24 @@ struct hash<smacpp::VarCopyInfo> {
     }
 };
 
-template<>
-struct hash<smacpp::ComputeInfo> {
-    std::size_t operator()(const smacpp::ComputeInfo& k) const;
-};
-
 template<>
 struct hash<smacpp::VariableState> {
     std::size_t operator()(const smacpp::VariableState& k) const
     {
-        return hash<std::variant<std::monostate, smacpp::BufferInfo, smacpp::PrimitiveInfo,
-                   smacpp::VarCopyInfo, smacpp::ComputeInfo>>()(k.Value) ^
-               (hash<smacpp::VariableState::STATE>()(k.State) << 1);
+        return k.Hash();
     }
 };
 
-inline std::size_t hash<smacpp::ComputeInfo>::operator()(const smacpp::ComputeInfo& k) const
-{
-    return hash<smacpp::VariableState>()(*k.LHS) ^
-           (hash<smacpp::VariableState>()(*k.LHS) << 1) ^
-           (hash<smacpp::OPERATOR>()(k.Operation) << 2);
-}
+template<>
+struct hash<smacpp::ComputeInfo> {
+    std::size_t operator()(const smacpp::ComputeInfo& k) const
+    {
+        return smacpp::CombineHash(
+            smacpp::CombineHash(smacpp::MixHash(static_cast<uint64_t>(k.Operation)),
+                k.LHS.Hash()),
+            k.RHS.Hash());
+    }
+};
 
 // For variable lists to work with hashing
 template<>
@@ -0,0 +1,164 @@
+// Micro-benchmark comparing the compact VariableState against the previous std::variant
+// based layout. Run with: make -C build benchmark
+#include "parse/Variable.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace smacpp;
+
+namespace legacy {
+
+// Copy of the layout VariableState used before it was made trivially copyable. Only the
+// parts that affect copying, hashing and comparing are kept
+struct LegacyState;
+
+using Primitive = std::variant<bool, long long, double>;
+
+struct CopyInfo {
+    bool operator==(const CopyInfo& other) const
+    {
+        return Source == other.Source;
+    }
+
+    std::string Source;
+};
+
+struct Compute {
+    bool operator==(const Compute& other) const
+    {
+        return Operation == other.Operation && LHS == other.LHS && RHS == other.RHS;
+    }
+
+    OPERATOR Operation;
+    std::shared_ptr<LegacyState> LHS;
+    std::shared_ptr<LegacyState> RHS;
+};
+
+struct LegacyState {
+    bool operator==(const LegacyState& other) const
+    {
+        return State == other.State && Value == other.Value;
+    }
+
+    VariableState::STATE State = VariableState::STATE::Unknown;
+    std::variant<std::monostate, BufferInfo, Primitive, CopyInfo, Compute> Value;
+};
+
+struct Hash {
+    std::size_t operator()(const LegacyState& k) const
+    {
+        std::size_t value = std::hash<int>()(static_cast<int>(k.State));
+
+        if(auto buffer = std::get_if<BufferInfo>(&k.Value); buffer) {
+            value ^= std::hash<size_t>()(buffer->AllocatedSize) << 1;
+        } else if(auto primitive = std::get_if<Primitive>(&k.Value); primitive) {
+            value ^= std::hash<Primitive>()(*primitive) << 1;
+        } else if(auto copy = std::get_if<CopyInfo>(&k.Value); copy) {
+            value ^= std::hash<std::string>()(copy->Source) << 1;
+        } else if(auto compute = std::get_if<Compute>(&k.Value); compute) {
+            value ^= std::hash<int>()(static_cast<int>(compute->Operation)) << 1;
+        }
+
+        return value;
+    }
+};
+
+} // namespace legacy
+
+constexpr size_t STATE_COUNT = 4096;
+constexpr size_t ROUNDS = 200;
+
+template<class Func>
+double Measure(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < ROUNDS; ++i)
+        func();
+
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           (ROUNDS * STATE_COUNT);
+}
+
+// Prevents the optimizer from removing the measured work
+volatile size_t Sink = 0;
+
+template<class State, class Hasher>
+void RunBenchmark(const char* name, const std::vector<State>& states)
+{
+    const double copy = Measure([&]() {
+        std::vector<State> copied = states;
+        Sink = Sink + copied.size();
+    });
+
+    const double hash = Measure([&]() {
+        size_t result = 0;
+        for(const auto& state : states)
+            result ^= Hasher()(state);
+        Sink = Sink + result;
+    });
+
+    const double compare = Measure([&]() {
+        size_t equal = 0;
+        for(size_t i = 1; i < states.size(); ++i)
+            equal += states[i] == states[i - 1] ? 1 : 0;
+        Sink = Sink + equal;
+    });
+
+    std::cout << name << " (" << sizeof(State) << " bytes): copy " << copy << " ns, hash "
+              << hash << " ns, compare " << compare << " ns per state\n";
+}
+
+int main()
+{
+    std::vector<legacy::LegacyState> before;
+    std::vector<VariableState> after;
+
+    const auto leaf = std::make_shared<legacy::LegacyState>();
+    const VariableState leafState(VarCopyInfo(VariableIdentifier("benchmark_variable_0")));
+
+    for(size_t i = 0; i < STATE_COUNT; ++i) {
+        legacy::LegacyState old;
+
+        switch(i % 4) {
+        case 0: {
+            const PrimitiveInfo value(static_cast<PrimitiveInfo::Integer>(i));
+            old.State = VariableState::STATE::Primitive;
+            old.Value = legacy::Primitive(static_cast<long long>(i));
+            after.push_back(VariableState(value));
+            break;
+        }
+        case 1:
+            old.State = VariableState::STATE::Buffer;
+            old.Value = BufferInfo(i);
+            after.push_back(VariableState(BufferInfo(i)));
+            break;
+        case 2: {
+            const auto name = "benchmark_variable_" + std::to_string(i % 64);
+            old.State = VariableState::STATE::CopyVar;
+            old.Value = legacy::CopyInfo{name};
+            after.push_back(VariableState(VarCopyInfo(VariableIdentifier(name))));
+            break;
+        }
+        case 3:
+            old.State = VariableState::STATE::Compute;
+            old.Value = legacy::Compute{OPERATOR::Add, leaf, leaf};
+            after.push_back(VariableState(ComputeInfo(leafState, OPERATOR::Add, leafState)));
+            break;
+        }
+
+        before.push_back(std::move(old));
+    }
+
+    RunBenchmark<legacy::LegacyState, legacy::Hash>("before", before);
+    RunBenchmark<VariableState, std::hash<VariableState>>("after", after);
+
+    return 0;
+}
@@ -0,0 +1,633 @@
+// Tests for running the analysis over multiple functions
+#include "catch.hpp"
+
+#include "analysis/BlockRegistry.h"
+#include "analysis/CallGraph.h"
+#include "analysis/FunctionSummary.h"
+#include "parse/Condition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace smacpp;
+
+namespace {
+
+//! \brief Makes a registry where main calls a function accessing a 3 element buffer with
+//! the indexes 0 to callCount - 1
+BlockRegistry MakeFanOutRegistry(int callCount)
+{
+    BlockRegistry registry;
+
+    const VariableIdentifier index("analyzer_test_index");
+    const VariableIdentifier buffer("analyzer_test_buffer");
+
+    CodeBlock callee("analyzer_test_callee", clang::SourceLocation{});
+    callee.AddFunctionParameter(index);
+    callee.AddLocalVariable(buffer);
+    callee.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(3))});
+    callee.AddProcessedAction(
+        Condition(), action::ArrayIndexAccess{buffer, VariableState(VarCopyInfo(index))});
+
+    CodeBlock main("main", clang::SourceLocation{});
+
+    for(int i = 0; i < callCount; ++i) {
+        main.AddFunctionCall(
+            Condition(), "analyzer_test_callee", {VariableState(PrimitiveInfo(i))});
+    }
+
+    registry.AddBlock(std::move(callee));
+    registry.AddBlock(std::move(main));
+    return registry;
+}
+
+std::vector<std::string> GetMessages(const std::vector<FoundProblem>& problems)
+{
+    std::vector<std::string> messages;
+
+    for(const auto& problem : problems)
+        messages.push_back(problem.Message);
+
+    return messages;
+}
+
+} // namespace
+
+TEST_CASE("Parallel analysis finds the same problems in a fixed order", "[analyzer]")
+{
+    const auto registry = MakeFanOutRegistry(40);
+
+    AnalysisOptions options;
+    const auto sequential = registry.PerformAnalysis(options);
+
+    CHECK(sequential.size() == 37);
+
+    options.Jobs = 4;
+    options.ContextLimit = 0;
+    const auto first = registry.PerformAnalysis(options);
+    const auto second = registry.PerformAnalysis(options);
+
+    CHECK(first.size() == sequential.size());
+    CHECK(GetMessages(first) == GetMessages(second));
+}
+
+TEST_CASE("DoneAnalysisRegistry adds each call once across threads", "[analyzer]")
+{
+    DoneAnalysisRegistry registry;
+    const CodeBlock first("registry_test_first", clang::SourceLocation{});
+    const CodeBlock second("registry_test_second", clang::SourceLocation{});
+
+    std::atomic<int> added(0);
+    std::vector<std::thread> threads;
+
+    for(int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&]() {
+            for(int i = 0; i < 200; ++i) {
+                const std::vector<VariableState> params{VariableState(PrimitiveInfo(i))};
+
+                added += registry.CheckAndAdd(&first, params);
+                added += registry.CheckAndAdd(&second, params);
+            }
+        });
+    }
+
+    for(auto& thread : threads)
+        thread.join();
+
+    CHECK(added == 400);
+    CHECK(registry.GetCallCount() == 400);
+    CHECK(registry.HasBeenDone(&first, {VariableState(PrimitiveInfo(5))}));
+    CHECK(!registry.HasBeenDone(&first, {VariableState(PrimitiveInfo(200))}));
+}
+
+TEST_CASE("Calls past the context limit are analysed with widened parameters", "[analyzer]")
+{
+    DoneAnalysisRegistry registry;
+    registry.SetContextLimit(2);
+
+    const CodeBlock function("widening_test", clang::SourceLocation{});
+    const VariableState buffer(BufferInfo(3));
+
+    const auto call = [&](int value) {
+        return registry.AddCall(&function, {buffer, VariableState(PrimitiveInfo(value))});
+    };
+
+    REQUIRE(call(1));
+    REQUIRE(call(2));
+    CHECK(!call(2));
+
+    // The third tuple is joined with the previous ones, the parameter that is the same in
+    // all of them is kept and the growing bound of the other one is widened
+    const auto widened = call(3);
+    REQUIRE(widened);
+    CHECK((*widened)[0] == buffer);
+    REQUIRE((*widened)[1].State == VariableState::STATE::Range);
+    CHECK((*widened)[1].GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int64, 1, INT64_MAX));
+
+    // Further calls don't make the join any wider
+    CHECK(!call(4));
+    CHECK(!call(5));
+
+    const auto wider = registry.AddCall(&function, {VariableState(), VariableState()});
+    REQUIRE(wider);
+    CHECK((*wider)[0].State == VariableState::STATE::Unknown);
+
+    // Without a limit every distinct tuple is analysed as is
+    DoneAnalysisRegistry unlimited;
+    unlimited.SetContextLimit(0);
+
+    for(int i = 0; i < 100; ++i) {
+        const std::vector<VariableState> params{VariableState(PrimitiveInfo(i))};
+        CHECK(unlimited.AddCall(&function, params) == params);
+    }
+
+    // In the analysis the indexes 3 to 7 are checked one by one and the rest with a single
+    // interval
+    const auto fanOut = MakeFanOutRegistry(40);
+
+    AnalysisOptions options;
+    options.ContextLimit = 8;
+
+    const auto problems = fanOut.PerformAnalysis(options);
+    REQUIRE(problems.size() == 6);
+    CHECK(problems.back().Severity == FoundProblem::SEVERITY::Warning);
+    CHECK(problems.back().Message ==
+          "Possible buffer overflow: buffer size: 3 used index: [0, 9223372036854775807]");
+}
+
+TEST_CASE("Unknown conditions fork the analysis", "[analyzer]")
+{
+    const VariableIdentifier flag("fork_test_flag");
+    const VariableIdentifier index("fork_test_index");
+    const VariableIdentifier buffer("fork_test_buffer");
+    const Condition isSet(
+        VariableValueCondition(flag, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    CodeBlock block("fork_test", clang::SourceLocation{});
+    block.AddFunctionParameter(flag);
+    block.AddLocalVariable(index);
+    block.AddLocalVariable(buffer);
+    block.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(3))});
+    block.AddProcessedAction(
+        isSet, action::VarDeclared{index, VariableState(PrimitiveInfo(5))});
+    block.EndActionGroup();
+    block.AddProcessedAction(
+        isSet.Negate(), action::VarDeclared{index, VariableState(PrimitiveInfo(1))});
+    block.EndActionGroup();
+    block.AddProcessedAction(
+        Condition(), action::ArrayIndexAccess{buffer, VariableState(VarCopyInfo(index))});
+
+    std::vector<FoundProblem> problems;
+    Analyzer analyzer(problems);
+
+    SECTION("Only the path where the flag is set overflows")
+    {
+        REQUIRE(analyzer.BeginAnalysis(block, nullptr, {VariableState()}));
+
+        REQUIRE(problems.size() == 1);
+        CHECK(problems[0].Message == "Buffer overflow: buffer size: 3 used index: 5");
+    }
+
+    SECTION("Without forks the unknown branches are skipped")
+    {
+        analyzer.SetForkDepthLimit(0);
+        REQUIRE(analyzer.BeginAnalysis(block, nullptr, {VariableState()}));
+
+        CHECK(problems.empty());
+    }
+}
+
+TEST_CASE("Called functions fork the same in both analysis modes", "[analyzer]")
+{
+    const VariableIdentifier caller("depth_test_caller_flag");
+    const VariableIdentifier value("depth_test_value");
+    const VariableIdentifier callee("depth_test_callee_flag");
+    const VariableIdentifier buffer("depth_test_buffer");
+    const auto isSet = [](const VariableIdentifier& flag) {
+        return Condition(
+            VariableValueCondition(flag, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+    };
+
+    CodeBlock called("depth_test_callee", clang::SourceLocation{});
+    called.AddFunctionParameter(callee);
+    called.AddLocalVariable(buffer);
+    called.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(3))});
+    called.AddProcessedAction(isSet(callee),
+        action::ArrayIndexAccess{buffer, VariableState(PrimitiveInfo(5))});
+
+    // The call is made after the caller has already used its only fork
+    CodeBlock main("main", clang::SourceLocation{});
+    main.AddFunctionParameter(caller);
+    main.AddLocalVariable(value);
+    main.AddProcessedAction(
+        isSet(caller), action::VarDeclared{value, VariableState(PrimitiveInfo(1))});
+    main.EndActionGroup();
+    main.AddFunctionCall(Condition(), "depth_test_callee", {VariableState()});
+
+    BlockRegistry registry;
+    registry.AddBlock(std::move(called));
+    registry.AddBlock(std::move(main));
+
+    const auto analyse = [&](bool depthFirst) {
+        std::vector<FoundProblem> problems;
+        Analyzer analyzer(problems);
+        analyzer.SetDepthFirst(depthFirst);
+        analyzer.SetForkDepthLimit(1);
+        REQUIRE(analyzer.BeginAnalysis(*registry.FindFunction("main"), &registry,
+            {VariableState()}));
+        return GetMessages(problems);
+    };
+
+    const auto queued = analyse(false);
+    REQUIRE(queued.size() == 1);
+    CHECK(queued[0] == "Buffer overflow: buffer size: 3 used index: 5");
+    CHECK(analyse(true) == queued);
+}
+
+TEST_CASE("Writes after a fork override the assumed condition", "[analyzer]")
+{
+    const VariableIdentifier flag("assumption_test_flag");
+    const VariableIdentifier index("assumption_test_index");
+    const VariableIdentifier buffer("assumption_test_buffer");
+    const Condition isSet(
+        VariableValueCondition(flag, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    CodeBlock block("assumption_test", clang::SourceLocation{});
+    block.AddFunctionParameter(flag);
+    block.AddLocalVariable(index);
+    block.AddLocalVariable(buffer);
+    block.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(3))});
+    block.AddProcessedAction(
+        isSet, action::VarDeclared{index, VariableState(PrimitiveInfo(1))});
+    block.EndActionGroup();
+    block.AddProcessedAction(
+        Condition(), action::VarAssigned{flag, VariableState(PrimitiveInfo(0))});
+    block.EndActionGroup();
+    block.AddProcessedAction(
+        isSet, action::ArrayIndexAccess{buffer, VariableState(PrimitiveInfo(5))});
+
+    std::vector<FoundProblem> problems;
+    Analyzer analyzer(problems);
+
+    // The flag is cleared on both paths so the access is never done
+    SECTION("Queue based")
+    {
+        REQUIRE(analyzer.BeginAnalysis(block, nullptr, {VariableState()}));
+        CHECK(problems.empty());
+    }
+
+    SECTION("Depth first")
+    {
+        analyzer.SetDepthFirst(true);
+        REQUIRE(analyzer.BeginAnalysis(block, nullptr, {VariableState()}));
+        CHECK(problems.empty());
+    }
+}
+
+TEST_CASE("Each function call has its own fork budget", "[analyzer]")
+{
+    BlockRegistry registry;
+
+    const VariableIdentifier index("budget_test_index");
+    const VariableIdentifier first("budget_test_first");
+    const VariableIdentifier second("budget_test_second");
+    const VariableIdentifier buffer("budget_test_buffer");
+
+    CodeBlock callee("budget_test_callee", clang::SourceLocation{});
+    callee.AddFunctionParameter(index);
+    callee.AddFunctionParameter(first);
+    callee.AddFunctionParameter(second);
+    callee.AddLocalVariable(buffer);
+    callee.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(3))});
+
+    for(const auto& flag : {first, second}) {
+        const Condition isSet(
+            VariableValueCondition(flag, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+        callee.AddProcessedAction(
+            isSet, action::ArrayIndexAccess{buffer, VariableState(VarCopyInfo(index))});
+        callee.EndActionGroup();
+    }
+
+    CodeBlock main("main", clang::SourceLocation{});
+
+    for(int i = 0; i < 20; ++i) {
+        main.AddFunctionCall(Condition(), "budget_test_callee",
+            {VariableState(PrimitiveInfo(i)), VariableState(), VariableState()});
+    }
+
+    registry.AddBlock(std::move(callee));
+    registry.AddBlock(std::move(main));
+
+    // With a single fork only the path where the first flag is set reaches an access
+    AnalysisOptions options;
+    options.PathBudget = 1;
+
+    auto sequential = registry.PerformAnalysis(options);
+    std::sort(sequential.begin(), sequential.end());
+    CHECK(sequential.size() == 17);
+
+    options.Jobs = 4;
+    options.ContextLimit = 0;
+
+    for(int run = 0; run < 3; ++run)
+        CHECK(GetMessages(registry.PerformAnalysis(options)) == GetMessages(sequential));
+}
+
+TEST_CASE("Function summaries are reused by later analyses", "[analyzer]")
+{
+    const VariableIdentifier global("summary_test_global");
+    const VariableIdentifier buffer("summary_test_buffer");
+
+    CodeBlock callee("summary_test_callee", clang::SourceLocation{});
+    callee.AddLocalVariable(buffer);
+    callee.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(2))});
+    callee.AddProcessedAction(
+        Condition(), action::ArrayIndexAccess{buffer, VariableState(PrimitiveInfo(4))});
+    callee.AddProcessedAction(
+        Condition(), action::VarAssigned{global, VariableState(PrimitiveInfo(7))});
+
+    const VariableIdentifier callerBuffer("summary_test_caller_buffer");
+
+    CodeBlock caller("summary_test_caller", clang::SourceLocation{});
+    caller.AddLocalVariable(callerBuffer);
+    caller.AddProcessedAction(
+        Condition(), action::VarDeclared{callerBuffer, VariableState(BufferInfo(3))});
+    caller.AddFunctionCall(Condition(), "summary_test_callee", {});
+    caller.AddProcessedAction(Condition(),
+        action::ArrayIndexAccess{callerBuffer, VariableState(VarCopyInfo(global))});
+
+    BlockRegistry registry;
+    registry.AddBlock(std::move(callee));
+    registry.AddBlock(std::move(caller));
+
+    const CodeBlock& entry = *registry.FindFunction("summary_test_caller");
+    const CodeBlock* called = registry.FindFunction("summary_test_callee");
+
+    SummaryCache summaries;
+    std::vector<FoundProblem> problems;
+
+    {
+        Analyzer analyzer(problems);
+        analyzer.SetSummaryCache(&summaries);
+        REQUIRE(analyzer.BeginAnalysis(entry, &registry, {}));
+    }
+
+    REQUIRE(problems.size() == 1);
+    CHECK(summaries.GetHitCount() == 0);
+
+    // The summaries can't be found before they are published
+    CHECK(summaries.GetSize() == 0);
+    CHECK(!summaries.Find(called, {}));
+    summaries.Publish();
+    CHECK(summaries.GetSize() == 2);
+
+    const auto summary = summaries.Find(called, {});
+    REQUIRE(summary);
+    CHECK(summary->Problems.size() == 1);
+    REQUIRE(summary->Globals.Find(global.ID));
+    CHECK(summary->Globals.Find(global.ID)->GetPrimitive() == PrimitiveInfo(7));
+
+    // A new analysis with its own registry reports the problem from the summary
+    {
+        Analyzer analyzer(problems);
+        analyzer.SetSummaryCache(&summaries);
+        REQUIRE(analyzer.BeginAnalysis(entry, &registry, {}));
+    }
+
+    // The global the callee writes is also seen by the caller after the call
+    REQUIRE(problems.size() == 3);
+    CHECK(problems[1].Message == problems[0].Message);
+    CHECK(problems[2].Message == "Buffer overflow: buffer size: 3 used index: 7");
+
+    // The other hits are the Find above and the lookup of the globals
+    CHECK(summaries.GetHitCount() == 3);
+}
+
+TEST_CASE("Call graph components are ordered bottom up", "[analyzer]")
+{
+    BlockRegistry registry;
+
+    const auto addFunction = [&](const std::string& name,
+                                 const std::vector<std::string>& callees) {
+        CodeBlock block(name, clang::SourceLocation{});
+
+        for(const auto& callee : callees)
+            block.AddFunctionCall(Condition(), callee, {});
+
+        registry.AddBlock(std::move(block));
+    };
+
+    addFunction("graph_a", {"graph_b", "graph_missing"});
+    addFunction("graph_b", {"graph_c"});
+    addFunction("graph_c", {"graph_b"});
+    addFunction("graph_d", {});
+
+    const CallGraph graph(registry);
+    REQUIRE(graph.GetFunctions().size() == 4);
+    CHECK(graph.GetFunctions()[0]->GetName() == "graph_a");
+
+    // The call to the missing function is left out
+    CHECK(graph.GetCallees(0) == std::vector<uint32_t>{1});
+
+    CHECK(graph.GetComponentCount() == 3);
+    CHECK(graph.GetComponent(1) == graph.GetComponent(2));
+    CHECK(graph.GetMembers(graph.GetComponent(1)).size() == 2);
+
+    const auto& levels = graph.GetLevels();
+    REQUIRE(levels.size() == 2);
+    CHECK(levels[0].size() == 2);
+    CHECK(levels[1] == std::vector<uint32_t>{graph.GetComponent(0)});
+
+    CHECK(graph.FindReachable(0) == std::vector<bool>{true, true, true, false});
+    CHECK(graph.FindReachable(2) == std::vector<bool>{false, true, true, false});
+}
+
+TEST_CASE("Bottom up analysis finds the problems of the top down analysis", "[analyzer]")
+{
+    auto registry = MakeFanOutRegistry(40);
+
+    // Problems in functions main doesn't call aren't reported
+    const VariableIdentifier buffer("analyzer_test_unused_buffer");
+
+    CodeBlock unused("analyzer_test_unused", clang::SourceLocation{});
+    unused.AddLocalVariable(buffer);
+    unused.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(1))});
+    unused.AddProcessedAction(
+        Condition(), action::ArrayIndexAccess{buffer, VariableState(PrimitiveInfo(1))});
+    registry.AddBlock(std::move(unused));
+
+    AnalysisOptions options;
+    auto topDown = registry.PerformAnalysis(options);
+
+    options.BottomUp = true;
+    options.Jobs = 4;
+    const auto bottomUp = registry.PerformAnalysis(options);
+
+    // The sequential analysis reports in the order it finds the problems
+    std::sort(topDown.begin(), topDown.end());
+
+    CHECK(bottomUp.size() == topDown.size());
+    CHECK(GetMessages(bottomUp) == GetMessages(topDown));
+}
+
+TEST_CASE("Bottom up analysis doesn't report paths main doesn't take", "[analyzer]")
+{
+    const VariableIdentifier count("path_test_count");
+    const VariableIdentifier buffer("path_test_buffer");
+
+    // The access is only out of bounds when count is 10, which main never passes
+    CodeBlock callee("path_test_callee", clang::SourceLocation{});
+    callee.AddFunctionParameter(count);
+    callee.AddLocalVariable(buffer);
+    callee.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(5))});
+    const VariableState ten(PrimitiveInfo(PRIMITIVE_TYPE::Int32, 10));
+    callee.AddProcessedAction(
+        Condition(VariableValueCondition(count, ValueRange(COMPARISON::EQUAL, ten))),
+        action::ArrayIndexAccess{buffer, VariableState(VarCopyInfo(count))});
+
+    CodeBlock main("main", clang::SourceLocation{});
+    main.AddFunctionCall(Condition(), "path_test_callee",
+        {VariableState(PrimitiveInfo(PRIMITIVE_TYPE::Int32, 1))});
+
+    BlockRegistry registry;
+    registry.AddBlock(std::move(callee));
+    registry.AddBlock(std::move(main));
+
+    AnalysisOptions options;
+    const auto topDown = registry.PerformAnalysis(options);
+
+    options.BottomUp = true;
+    const auto bottomUp = registry.PerformAnalysis(options);
+
+    CHECK(topDown.empty());
+    CHECK(GetMessages(bottomUp) == GetMessages(topDown));
+}
+
+TEST_CASE("Bottom up analysis only uses the summaries of finished levels", "[analyzer]")
+{
+    const VariableIdentifier global("level_test_global");
+    const VariableIdentifier value("level_test_value");
+    const VariableIdentifier buffer("level_test_buffer");
+
+    BlockRegistry registry;
+
+    CodeBlock setter("level_test_setter", clang::SourceLocation{});
+    setter.AddFunctionParameter(value);
+    setter.AddProcessedAction(
+        Condition(), action::VarAssigned{global, VariableState(VarCopyInfo(value))});
+    registry.AddBlock(std::move(setter));
+
+    // Two callers on the same level share each call so which one finishes first would decide
+    // if the other sees the global the call writes
+    const auto addUser = [&](const std::string& name, const std::vector<std::string>& calls,
+                             int setValue) {
+        CodeBlock block(name, clang::SourceLocation{});
+        block.AddLocalVariable(buffer);
+        block.AddProcessedAction(
+            Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(1))});
+
+        for(const auto& call : calls)
+            block.AddFunctionCall(Condition(), call, {});
+
+        block.AddFunctionCall(
+            Condition(), "level_test_setter", {VariableState(PrimitiveInfo(setValue))});
+        block.AddProcessedAction(
+            Condition(), action::ArrayIndexAccess{buffer, VariableState(VarCopyInfo(global))});
+        registry.AddBlock(std::move(block));
+    };
+
+    std::vector<std::string> callers;
+
+    for(int i = 0; i < 16; ++i) {
+        callers.push_back("level_test_caller_" + std::to_string(i));
+        addUser(callers.back(), {}, 10 + i / 2);
+    }
+
+    addUser("main", callers, 10);
+
+    AnalysisOptions options;
+    options.BottomUp = true;
+    const auto sequential = registry.PerformAnalysis(options);
+
+    // Only main sees the global from a summary, the callers only have the summary of the
+    // setter for an unknown value
+    REQUIRE(sequential.size() == 1);
+    CHECK(sequential[0].Message == "Buffer overflow: buffer size: 1 used index: 10");
+
+    options.Jobs = 4;
+
+    for(int i = 0; i < 10; ++i)
+        CHECK(GetMessages(registry.PerformAnalysis(options)) == GetMessages(sequential));
+}
+
+TEST_CASE("Assumed conditions narrow an unknown index to an interval", "[analyzer]")
+{
+    const VariableIdentifier index("interval_test_index");
+    const VariableIdentifier buffer("interval_test_buffer");
+    const auto compare = [&](COMPARISON op, int value) {
+        const VariableState constant(PrimitiveInfo(PRIMITIVE_TYPE::Int32, value));
+        return Condition(VariableValueCondition(index, ValueRange(op, constant)));
+    };
+    const Condition notNegative = compare(COMPARISON::GREATER_THAN_EQUAL, 0);
+
+    const auto analyse = [&](const Condition& guard) {
+        CodeBlock block("interval_test", clang::SourceLocation{});
+        block.AddFunctionParameter(index);
+        block.AddLocalVariable(buffer);
+        block.AddProcessedAction(
+            Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(4))});
+        block.AddProcessedAction(
+            guard, action::ArrayIndexAccess{buffer, VariableState(VarCopyInfo(index))});
+
+        std::vector<FoundProblem> problems;
+        Analyzer analyzer(problems);
+        REQUIRE(analyzer.BeginAnalysis(block, nullptr, {VariableState()}));
+        return problems;
+    };
+
+    // A correct bounds check covers all the values
+    CHECK(analyse(notNegative.And(compare(COMPARISON::LESS_THAN, 4))).empty());
+
+    const auto problems = analyse(notNegative.And(compare(COMPARISON::LESS_THAN, 6)));
+    REQUIRE(problems.size() == 1);
+    CHECK(problems[0].Message ==
+          "Possible buffer overflow: buffer size: 4 used index: [0, 5]");
+
+    // Without an upper bound any index could overflow
+    const auto unbounded = analyse(compare(COMPARISON::GREATER_THAN, 2));
+    REQUIRE(unbounded.size() == 1);
+    CHECK(unbounded[0].Severity == FoundProblem::SEVERITY::Warning);
+    CHECK(unbounded[0].Message ==
+          "Possible buffer overflow: buffer size: 4 used index: [3, 2147483647]");
+
+    // And without a lower bound any index could be negative
+    const auto negative = analyse(compare(COMPARISON::LESS_THAN, 2));
+    REQUIRE(negative.size() == 1);
+    CHECK(negative[0].Severity == FoundProblem::SEVERITY::Warning);
+    CHECK(negative[0].Message ==
+          "Possible buffer underflow: buffer size: 4 used index: [-2147483648, 1]");
+
+    const auto below = analyse(compare(COMPARISON::LESS_THAN, 0));
+    REQUIRE(below.size() == 1);
+    CHECK(below[0].Severity == FoundProblem::SEVERITY::Error);
+    CHECK(below[0].Message ==
+          "Buffer underflow: buffer size: 4 used index: [-2147483648, -1]");
+
+    const auto constant = analyse(compare(COMPARISON::EQUAL, -1));
+    REQUIRE(constant.size() == 1);
+    CHECK(constant[0].Message == "Buffer underflow: buffer size: 4 used index: -1");
+
+    // Unless every value the guard allows is past the end
+    const auto past = analyse(compare(COMPARISON::GREATER_THAN_EQUAL, 4));
+    REQUIRE(past.size() == 1);
+    CHECK(past[0].Message == "Buffer overflow: buffer size: 4 used index: [4, 2147483647]");
+}
@@ -0,0 +1,131 @@
+// Tests for building CodeBlocks from C code
+#include "catch.hpp"
+
+#include "analysis/BlockRegistry.h"
+#include "parse/CodeBlockBuildingVisitor.h"
+#include "parse/Condition.h"
+
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Tooling/Tooling.h>
+
+#include <map>
+
+using namespace smacpp;
+
+namespace {
+
+//! \brief Builds the blocks of C code into registry
+//! \returns The AST, it needs to be kept alive while the symbols refer to its declarations
+std::unique_ptr<clang::ASTUnit> BuildBlocks(const std::string& code, BlockRegistry& registry)
+{
+    auto ast = clang::tooling::buildASTFromCode(code, "input.c");
+
+    if(ast) {
+        CodeBlockBuildingVisitor visitor(ast->getASTContext(), registry, false);
+        visitor.TraverseDecl(ast->getASTContext().getTranslationUnitDecl());
+    }
+
+    return ast;
+}
+
+class SingleValue : public VariableValueProvider {
+public:
+    SingleValue(VariableIdentifier variable, VariableState value) :
+        Variable(variable), Value(value)
+    {}
+
+    VariableState GetVariableValue(const VariableIdentifier& variable) const override
+    {
+        return GetVariableValueRaw(variable);
+    }
+
+    VariableState GetVariableValueRaw(const VariableIdentifier& variable) const override
+    {
+        return variable == Variable ? Value : VariableState();
+    }
+
+    VariableIdentifier Variable;
+    VariableState Value;
+};
+
+} // namespace
+
+TEST_CASE("Only literal initializers give variables a value", "[parse]")
+{
+    BlockRegistry registry;
+    const auto ast = BuildBlocks(R"(
+int g(int value);
+
+void f(int y, int* a)
+{
+    int sum = y + 1;
+    int call = g(3);
+    int element = a[2];
+    int negated = -y + 3;
+    int literal = -5;
+    int parenthesized = (7);
+}
+)",
+        registry);
+    REQUIRE(ast);
+
+    const CodeBlock* function = registry.FindFunction("f");
+    REQUIRE(function);
+
+    std::map<std::string, VariableState> declared;
+
+    for(const auto& action : function->GetActions()) {
+        if(const auto* var = std::get_if<action::VarDeclared>(&action.Action); var)
+            declared[var->Variable.Dump()] = var->State;
+    }
+
+    // The literals inside other expressions aren't the value of the variable
+    CHECK(declared.at("sum").State == VariableState::STATE::Unknown);
+    CHECK(declared.at("call").State == VariableState::STATE::Unknown);
+    CHECK(declared.at("element").State == VariableState::STATE::Unknown);
+    CHECK(declared.at("negated").State == VariableState::STATE::Unknown);
+
+    CHECK(declared.at("literal") == VariableState(PrimitiveInfo(PRIMITIVE_TYPE::Int32, -5)));
+    CHECK(declared.at("parenthesized") ==
+          VariableState(PrimitiveInfo(PRIMITIVE_TYPE::Int32, 7)));
+}
+
+TEST_CASE("Case values are converted to the type of the switch", "[parse]")
+{
+    BlockRegistry registry;
+    const auto ast = BuildBlocks(R"(
+void f(unsigned u)
+{
+    int x = 0;
+
+    switch(u) {
+    case -1:
+        x = 1;
+        break;
+    }
+}
+)",
+        registry);
+    REQUIRE(ast);
+
+    const CodeBlock* function = registry.FindFunction("f");
+    REQUIRE(function);
+    REQUIRE(function->GetParameters().size() == 1);
+
+    const SingleValue values(function->GetParameters()[0],
+        VariableState(PrimitiveInfo(PRIMITIVE_TYPE::UInt32, 0xffffffff)));
+
+    const auto& actions = function->GetActions();
+    bool found = false;
+
+    for(const auto& group : function->GetActionGroups()) {
+        for(auto i = group.Begin; i < group.End; ++i) {
+            if(std::holds_alternative<action::VarAssigned>(actions[i].Action)) {
+                found = true;
+                CHECK(group.If.Evaluate(values) == TRI_STATE::True);
+            }
+        }
+    }
+
+    CHECK(found);
+}
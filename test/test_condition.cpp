@@ -0,0 +1,263 @@
+// Tests for building and evaluating conditions
+#include "catch.hpp"
+
+#include "parse/CodeBlock.h"
+#include "parse/ConditionArena.h"
+#include "parse/ConditionCompiler.h"
+
+#include <unordered_map>
+
+using namespace smacpp;
+
+class TestValues : public VariableValueProvider {
+public:
+    VariableState GetVariableValue(const VariableIdentifier& variable) const override
+    {
+        return GetVariableValueRaw(variable).Resolve(*this);
+    }
+
+    VariableState GetVariableValueRaw(const VariableIdentifier& variable) const override
+    {
+        const auto found = Values.find(variable);
+
+        if(found == Values.end())
+            return VariableState();
+
+        return found->second;
+    }
+
+    std::unordered_map<VariableIdentifier, VariableState> Values;
+};
+
+TEST_CASE("Equal conditions share their nodes", "[condition]")
+{
+    const Condition a(
+        VariableValueCondition("test_a", ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+    const Condition b(
+        VariableValueCondition("test_b", ValueRange(ValueRange::RANGE_CLASS::Zero)));
+
+    CHECK(a == Condition(VariableValueCondition(
+                   "test_a", ValueRange(ValueRange::RANGE_CLASS::NotZero))));
+    CHECK(a.And(b) == a.And(b));
+    CHECK(a.And(b) != b.And(a));
+    CHECK(a.Negate().Negate() == a);
+
+    const auto sizeBefore = ConditionArena::Get().GetNodeCount();
+    const auto combined = a.And(b).Or(a.And(b).Negate());
+    CHECK(combined == a.And(b).Or(a.And(b).Negate()));
+    CHECK(ConditionArena::Get().GetNodeCount() - sizeBefore <= 3);
+}
+
+TEST_CASE("Always true and false conditions simplify", "[condition]")
+{
+    const Condition a(
+        VariableValueCondition("test_a", ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+    const Condition always;
+    const Condition never = always.Negate();
+
+    CHECK(always.IsAlwaysTrue());
+    CHECK(never.IsAlwaysFalse());
+    CHECK(always.And(a) == a);
+    CHECK(a.And(always) == a);
+    CHECK(a.And(never).IsAlwaysFalse());
+    CHECK(a.Or(always).IsAlwaysTrue());
+    CHECK(a.Or(never) == a);
+}
+
+TEST_CASE("Conditions evaluate against variable values", "[condition]")
+{
+    const VariableIdentifier a("test_a");
+    const VariableIdentifier b("test_b");
+
+    TestValues values;
+    values.Values[a] = VariableState(PrimitiveInfo(5));
+    values.Values[b] = VariableState(PrimitiveInfo(0));
+
+    const Condition aLarge(VariableValueCondition(
+        a, ValueRange(COMPARISON::GREATER_THAN, VariableState(PrimitiveInfo(3)))));
+    const Condition bSet(
+        VariableValueCondition(b, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    CHECK(aLarge.Evaluate(values) == TRI_STATE::True);
+    CHECK(bSet.Evaluate(values) == TRI_STATE::False);
+    CHECK(aLarge.And(bSet).Evaluate(values) == TRI_STATE::False);
+    CHECK(aLarge.Or(bSet).Evaluate(values) == TRI_STATE::True);
+    CHECK(aLarge.And(bSet).Negate().Evaluate(values) == TRI_STATE::True);
+    CHECK(bSet.Negate().Evaluate(values) == TRI_STATE::True);
+
+    // Unknown values follow Kleene logic
+    const Condition unknown(
+        VariableValueCondition("test_unknown", ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+    CHECK(unknown.Evaluate(values) == TRI_STATE::Unknown);
+    CHECK(unknown.Negate().Evaluate(values) == TRI_STATE::Unknown);
+    CHECK(unknown.And(bSet).Evaluate(values) == TRI_STATE::False);
+    CHECK(unknown.And(aLarge).Evaluate(values) == TRI_STATE::Unknown);
+    CHECK(unknown.Or(aLarge).Evaluate(values) == TRI_STATE::True);
+    CHECK(unknown.Or(unknown.Negate()).Evaluate(values) == TRI_STATE::Unknown);
+}
+
+TEST_CASE("Case set ranges match by set membership", "[condition]")
+{
+    const VariableIdentifier a("test_a");
+
+    TestValues values;
+    values.Values[a] = VariableState(PrimitiveInfo(PRIMITIVE_TYPE::UInt8, 7));
+
+    const ValueRange cases(ValueRange::RANGE_CLASS::InSet, {9, 7, 1, 7});
+    CHECK(cases.Values == std::vector<ValueRange::SetValue>{1, 7, 9});
+
+    const Condition inCases(VariableValueCondition(a, cases));
+    CHECK(inCases.Evaluate(values) == TRI_STATE::True);
+    CHECK(inCases.Negate().Evaluate(values) == TRI_STATE::False);
+    CHECK(inCases.Negate() ==
+          Condition(VariableValueCondition(
+              a, ValueRange(ValueRange::RANGE_CLASS::NotInSet, {1, 7, 9}))));
+
+    values.Values[a] = VariableState(PrimitiveInfo(-1));
+    CHECK(inCases.Evaluate(values) == TRI_STATE::False);
+    CHECK(inCases.Negate().Evaluate(values) == TRI_STATE::True);
+}
+
+TEST_CASE("Compiled conditions match tree evaluation", "[condition]")
+{
+    const VariableIdentifier a("test_a");
+    const VariableIdentifier b("test_b");
+
+    const Condition aSet(
+        VariableValueCondition(a, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+    const Condition bSet(
+        VariableValueCondition(b, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    const std::vector<Condition> conditions = {aSet, aSet.And(bSet), aSet.Or(bSet),
+        aSet.And(bSet).Negate(), aSet.Or(bSet).And(aSet.And(bSet).Negate()),
+        aSet.Negate().Or(bSet.Negate()).Or(Condition().Negate())};
+
+    auto& compiler = ConditionCompiler::Get();
+
+    for(const auto& condition : conditions)
+        compiler.Compile(condition);
+
+    // Value 2 is used for an unknown value
+    for(int aValue = 0; aValue < 3; ++aValue) {
+        for(int bValue = 0; bValue < 3; ++bValue) {
+            TestValues values;
+
+            if(aValue < 2)
+                values.Values[a] = VariableState(PrimitiveInfo(aValue));
+            if(bValue < 2)
+                values.Values[b] = VariableState(PrimitiveInfo(bValue));
+
+            for(const auto& condition : conditions) {
+                INFO(condition.Dump() << " with a = " << aValue << " b = " << bValue);
+                INFO(compiler.Dump(condition));
+                REQUIRE(compiler.IsCompiled(condition));
+                CHECK(compiler.Evaluate(condition, values) ==
+                      ConditionArena::Get().Evaluate(condition.GetNodeID(), values));
+            }
+        }
+    }
+}
+
+TEST_CASE("Actions with the same guard are grouped", "[condition]")
+{
+    const Condition guard(
+        VariableValueCondition("group_a", ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+    const VariableIdentifier var("group_b");
+
+    CodeBlock block("group_test", clang::SourceLocation{});
+
+    block.AddProcessedAction(guard, action::VarAssigned{var, VariableState(PrimitiveInfo(1))});
+    block.AddProcessedAction(guard, action::VarAssigned{var, VariableState(PrimitiveInfo(2))});
+    block.AddProcessedAction(
+        Condition(), action::VarAssigned{var, VariableState(PrimitiveInfo(3))});
+
+    // A new statement with the same guard needs its own group
+    block.EndActionGroup();
+    block.AddProcessedAction(
+        Condition(), action::VarAssigned{var, VariableState(PrimitiveInfo(4))});
+
+    const auto& groups = block.GetActionGroups();
+    REQUIRE(groups.size() == 3);
+    CHECK(groups[0].If == guard);
+    CHECK(groups[0].Begin == 0);
+    CHECK(groups[0].End == 2);
+    CHECK(groups[1].Begin == 2);
+    CHECK(groups[1].End == 3);
+    CHECK(groups[2].Begin == 3);
+    CHECK(groups[2].End == 4);
+    CHECK(block.GetActions().size() == 4);
+}
+
+TEST_CASE("Blocks record the variables actions and guards access", "[condition]")
+{
+    const VariableIdentifier guarded("dependency_a");
+    const VariableIdentifier other("dependency_b");
+    const Condition guard(
+        VariableValueCondition(guarded, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    CodeBlock block("dependency_test", clang::SourceLocation{});
+
+    block.AddProcessedAction(
+        guard, action::VarAssigned{other, VariableState(VarCopyInfo(guarded))});
+    block.AddProcessedAction(Condition(), action::VarAssigned{guarded, VariableState()});
+    block.EndActionGroup();
+    block.AddProcessedAction(guard, action::ArrayIndexAccess{other, VariableState()});
+
+    // Both guard groups share the same guard index
+    const auto& groups = block.GetActionGroups();
+    REQUIRE(groups.size() == 3);
+    CHECK(groups[0].Guard == groups[2].Guard);
+    CHECK(block.GetGuards().size() == 2);
+
+    const auto guardReads = block.GetGuardReads(groups[0].Guard);
+    REQUIRE(guardReads.size() == 1);
+    CHECK(*guardReads.begin() == guarded);
+
+    REQUIRE(block.GetActionReads(0).size() == 1);
+    CHECK(*block.GetActionReads(0).begin() == guarded);
+    REQUIRE(block.GetActionWrites(0).size() == 1);
+    CHECK(*block.GetActionWrites(0).begin() == other);
+
+    REQUIRE(block.GetActionWrites(1).size() == 1);
+    CHECK(*block.GetActionWrites(1).begin() == guarded);
+    CHECK(block.GetActionWrites(2).empty());
+}
+
+TEST_CASE("Ranges narrow intervals", "[condition]")
+{
+    const TestValues values;
+    const VariableState limit(PrimitiveInfo(PRIMITIVE_TYPE::Int32, 8));
+    const VariableState interval(IntervalInfo(PRIMITIVE_TYPE::Int32, 0, 20));
+
+    const auto below = ValueRange(COMPARISON::LESS_THAN, limit).Refine(interval, values);
+    REQUIRE(below);
+    CHECK(below->GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int32, 0, 7));
+
+    const auto above =
+        ValueRange(COMPARISON::LESS_THAN, limit).Negate().Refine(interval, values);
+    REQUIRE(above);
+    CHECK(above->GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int32, 8, 20));
+
+    // Unknown values get the type of the value they are compared to
+    const auto unknown =
+        ValueRange(COMPARISON::GREATER_THAN, limit).Refine(VariableState(), values);
+    REQUIRE(unknown);
+    CHECK(unknown->GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int32, 9, INT32_MAX));
+
+    CHECK(*ValueRange(ValueRange::RANGE_CLASS::NotZero).Refine(interval, values) ==
+          VariableState(IntervalInfo(PRIMITIVE_TYPE::Int32, 1, 20)));
+    CHECK(*ValueRange(ValueRange::RANGE_CLASS::InSet, {3, 5}).Refine(interval, values) ==
+          VariableState(IntervalInfo(PRIMITIVE_TYPE::Int32, 3, 5)));
+
+    // Nothing matches so the path can't be taken
+    CHECK(!ValueRange(COMPARISON::GREATER_THAN, VariableState(PrimitiveInfo(20)))
+               .Refine(interval, values));
+
+    // Intervals match conditions that all or none of their values match
+    CHECK(ValueRange(COMPARISON::LESS_THAN, VariableState(PrimitiveInfo(21)))
+              .Matches(interval, values) == TRI_STATE::True);
+    CHECK(ValueRange(ValueRange::RANGE_CLASS::InSet, {-1, 21}).Matches(interval, values) ==
+          TRI_STATE::False);
+    CHECK(ValueRange(ValueRange::RANGE_CLASS::NotZero).Matches(interval, values) ==
+          TRI_STATE::Unknown);
+}
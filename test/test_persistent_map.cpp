@@ -0,0 +1,178 @@
+// Tests for the persistent program state storage
+#include "catch.hpp"
+
+#include "analysis/Analyzer.h"
+#include "analysis/EvaluationMemo.h"
+#include "analysis/PersistentIntMap.h"
+#include "parse/Variable.h"
+
+using namespace smacpp;
+
+TEST_CASE("PersistentIntMap stores and finds values", "[state]")
+{
+    PersistentIntMap<int> map;
+
+    CHECK(map.Empty());
+    CHECK(map.Find(0) == nullptr);
+
+    map.Set(3, 30);
+    map.Set(17, 170);
+    map.Set(100000, 5);
+
+    CHECK(map.Size() == 3);
+    REQUIRE(map.Find(3));
+    CHECK(*map.Find(3) == 30);
+    REQUIRE(map.Find(17));
+    CHECK(*map.Find(17) == 170);
+    REQUIRE(map.Find(100000));
+    CHECK(*map.Find(100000) == 5);
+    CHECK(map.Find(4) == nullptr);
+    CHECK(map.Find(0xFFFFFFFF) == nullptr);
+
+    map.Set(3, 31);
+    CHECK(map.Size() == 3);
+    CHECK(*map.Find(3) == 31);
+
+    std::vector<uint32_t> keys;
+    map.ForEach([&](uint32_t key, int) { keys.push_back(key); });
+    CHECK(keys == std::vector<uint32_t>{3, 17, 100000});
+}
+
+TEST_CASE("PersistentIntMap copies don't see each other's changes", "[state]")
+{
+    PersistentIntMap<VariableState> original;
+
+    for(uint32_t i = 0; i < 40; ++i)
+        original.Set(i, VariableState(PrimitiveInfo(i)));
+
+    auto fork = original;
+    CHECK(fork == original);
+    CHECK(fork.Hash() == original.Hash());
+
+    fork.Set(5, VariableState(BufferInfo(10)));
+
+    CHECK(fork != original);
+    CHECK(original.Find(5)->State == VariableState::STATE::Primitive);
+    CHECK(fork.Find(5)->State == VariableState::STATE::Buffer);
+
+    // Setting back to the same value makes the states equal again
+    fork.Set(5, VariableState(PrimitiveInfo(5)));
+    CHECK(fork == original);
+    CHECK(fork.Hash() == original.Hash());
+}
+
+TEST_CASE("PersistentIntMap equality doesn't depend on insertion order", "[state]")
+{
+    PersistentIntMap<int> first;
+    PersistentIntMap<int> second;
+
+    first.Set(1, 1);
+    first.Set(300, 2);
+
+    second.Set(300, 2);
+    second.Set(1, 1);
+
+    CHECK(first == second);
+    CHECK(first.Hash() == second.Hash());
+
+    second.Set(2, 0);
+    CHECK(first != second);
+}
+
+TEST_CASE("ProgramState rollback undoes changes after checkpoint", "[state]")
+{
+    ProgramState state;
+    const VariableIdentifier first("trail_test_first");
+    const VariableIdentifier second("trail_test_second");
+
+    state.Assign(first, VariableState(PrimitiveInfo(1)));
+    const ProgramState before = state;
+
+    const auto checkpoint = state.Checkpoint();
+    state.Assign(first, VariableState(PrimitiveInfo(2)));
+    state.CreateLocal(second, VariableState(BufferInfo(4)));
+
+    CHECK(state != before);
+    CHECK(state.GetVariableValueRaw(second).State == VariableState::STATE::Buffer);
+
+    state.Rollback(checkpoint);
+
+    CHECK(state == before);
+    CHECK(state.GetVariableValueRaw(first).GetPrimitive() == PrimitiveInfo(1));
+    CHECK(state.GetVariableValueRaw(second).State == VariableState::STATE::Unknown);
+}
+
+TEST_CASE("ProgramState stores copies as resolved values", "[state]")
+{
+    ProgramState state;
+    const VariableIdentifier first("copy_test_first");
+    const VariableIdentifier second("copy_test_second");
+
+    state.Assign(first, VariableState(PrimitiveInfo(1)));
+    state.Assign(second, VariableState(VarCopyInfo(first)));
+
+    CHECK(state.GetVariableValueRaw(second).State == VariableState::STATE::Primitive);
+
+    // Like in C the copy isn't affected by later assignments to the source
+    state.Assign(first, VariableState(PrimitiveInfo(2)));
+    CHECK(state.GetVariableValue(second).GetPrimitive() == PrimitiveInfo(1));
+}
+
+TEST_CASE("EvaluationMemo results are reused until an input is written", "[state]")
+{
+    ProgramState state;
+    EvaluationMemo memo;
+    const VariableIdentifier input("memo_test_input");
+    const VariableIdentifier other("memo_test_other");
+
+    const Condition condition(
+        VariableValueCondition(input, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    CHECK(memo.MatchesCondition(condition, state) == TRI_STATE::Unknown);
+
+    state.Assign(input, VariableState(PrimitiveInfo(1)));
+    CHECK(memo.MatchesCondition(condition, state) == TRI_STATE::True);
+    CHECK(memo.GetHitCount() == 0);
+
+    // Writing other variables doesn't invalidate the result
+    state.Assign(other, VariableState(PrimitiveInfo(0)));
+    CHECK(memo.MatchesCondition(condition, state) == TRI_STATE::True);
+    CHECK(memo.GetHitCount() == 1);
+
+    const auto checkpoint = state.Checkpoint();
+    state.Assign(input, VariableState(PrimitiveInfo(0)));
+    CHECK(memo.MatchesCondition(condition, state) == TRI_STATE::False);
+    CHECK(memo.GetHitCount() == 1);
+
+    // After rolling back the input has its old version but the memo only remembers the
+    // latest result
+    state.Rollback(checkpoint);
+    CHECK(memo.MatchesCondition(condition, state) == TRI_STATE::True);
+    CHECK(memo.GetMissCount() == 4);
+}
+
+TEST_CASE("EvaluationMemo copies share results but not later updates", "[state]")
+{
+    ProgramState state;
+    EvaluationMemo memo;
+    const VariableIdentifier input("memo_copy_test_input");
+
+    const Condition condition(
+        VariableValueCondition(input, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    state.Assign(input, VariableState(PrimitiveInfo(1)));
+    CHECK(memo.MatchesCondition(condition, state) == TRI_STATE::True);
+
+    // Like a forked operation the copy starts with the results of the original
+    ProgramState forkState = state;
+    EvaluationMemo fork = memo;
+    CHECK(fork.MatchesCondition(condition, forkState) == TRI_STATE::True);
+    CHECK(fork.GetHitCount() == 1);
+
+    forkState.Assign(input, VariableState(PrimitiveInfo(0)));
+    CHECK(fork.MatchesCondition(condition, forkState) == TRI_STATE::False);
+
+    // The result the fork computed isn't visible in the original
+    CHECK(memo.MatchesCondition(condition, state) == TRI_STATE::True);
+    CHECK(memo.GetHitCount() == 1);
+}
@@ -0,0 +1,68 @@
+// Tests for the C semantics of primitive value arithmetic
+#include "catch.hpp"
+
+#include "parse/ConstantPool.h"
+#include "parse/Variable.h"
+
+using namespace smacpp;
+
+TEST_CASE("Primitive arithmetic wraps around at the type width", "[primitive]")
+{
+    const PrimitiveInfo maxByte(PRIMITIVE_TYPE::UInt8, 255);
+    const PrimitiveInfo maxInt(PRIMITIVE_TYPE::Int32, 0x7fffffff);
+    const PrimitiveInfo one(PRIMITIVE_TYPE::Int32, 1);
+
+    // unsigned char is promoted to int so this doesn't wrap
+    CHECK(maxByte.ApplyOperator(OPERATOR::Add, one) ==
+          PrimitiveInfo(PRIMITIVE_TYPE::Int32, 256));
+
+    const auto wrapped = maxInt.ApplyOperator(OPERATOR::Add, one);
+    CHECK(wrapped.Type == PRIMITIVE_TYPE::Int32);
+    CHECK(wrapped.AsInteger() == -2147483648LL);
+
+    const PrimitiveInfo zero(PRIMITIVE_TYPE::UInt32, 0);
+    CHECK(zero.ApplyOperator(OPERATOR::Subtract, PrimitiveInfo(PRIMITIVE_TYPE::UInt32, 1))
+              .AsInteger() == 0xffffffffLL);
+
+    CHECK(maxByte.ConvertTo(PRIMITIVE_TYPE::Int8).AsInteger() == -1);
+}
+
+TEST_CASE("Primitive comparisons use the usual arithmetic conversions", "[primitive]")
+{
+    const PrimitiveInfo minusOne(
+        PRIMITIVE_TYPE::Int32, static_cast<PrimitiveInfo::WideBits>(-1));
+    const PrimitiveInfo unsignedOne(PRIMITIVE_TYPE::UInt32, 1);
+
+    // -1 is converted to UINT_MAX
+    CHECK(!minusOne.CompareTo(COMPARISON::LESS_THAN, unsignedOne));
+
+    // But fits in long long
+    CHECK(minusOne.CompareTo(COMPARISON::LESS_THAN, PrimitiveInfo(1)));
+
+    CHECK(PrimitiveInfo::FromDouble(0.5).CompareTo(
+        COMPARISON::GREATER_THAN, PrimitiveInfo(0)));
+    CHECK(PrimitiveInfo::FromBool(true).CompareTo(COMPARISON::EQUAL, unsignedOne));
+}
+
+TEST_CASE("128 bit values are stored through the constant pool", "[primitive]")
+{
+    ConstantPool::Get().Clear();
+
+    const PrimitiveInfo big(
+        PRIMITIVE_TYPE::UInt128, static_cast<PrimitiveInfo::WideBits>(1) << 100);
+
+    const VariableState state(big);
+    CHECK(state.GetPrimitive() == big);
+    CHECK(ConstantPool::Get().GetConstantCount() == 1);
+
+    // Small values stay inline and equal values share the pooled constant
+    const VariableState small(PrimitiveInfo(PRIMITIVE_TYPE::Int128, -5));
+    CHECK(small.GetPrimitive().AsInteger() == -5);
+    CHECK(VariableState(big) == state);
+    CHECK(ConstantPool::Get().GetConstantCount() == 1);
+
+    const auto literal = PrimitiveInfo::FromAPInt(llvm::APInt(128, 7), true);
+    REQUIRE(literal);
+    CHECK(literal->Type == PRIMITIVE_TYPE::Int128);
+    CHECK(!PrimitiveInfo::FromAPInt(llvm::APInt(256, 1), true));
+}
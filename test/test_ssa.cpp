@@ -0,0 +1,93 @@
+// Tests for the SSA lowering of CodeBlocks
+#include "catch.hpp"
+
+#include "analysis/Analyzer.h"
+#include "parse/SSAForm.h"
+
+#include <algorithm>
+
+using namespace smacpp;
+
+TEST_CASE("Conditional writes get gated phis", "[ssa]")
+{
+    const VariableIdentifier index("ssa_index");
+    const VariableIdentifier buffer("ssa_buffer");
+    const Condition guard(
+        VariableValueCondition(index, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    CodeBlock block("ssa_test", clang::SourceLocation{});
+
+    block.AddLocalVariable(index);
+    block.AddLocalVariable(buffer);
+    block.AddProcessedAction(
+        Condition(), action::VarDeclared{index, VariableState(PrimitiveInfo(1))});
+    block.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(3))});
+    block.AddProcessedAction(
+        guard, action::VarAssigned{index, VariableState(PrimitiveInfo(5))});
+    block.EndActionGroup();
+    block.AddProcessedAction(
+        Condition(), action::ArrayIndexAccess{buffer, VariableState(VarCopyInfo(index))});
+
+    block.BuildSSA();
+    REQUIRE(block.GetSSA());
+
+    const SSAForm& ssa = *block.GetSSA();
+
+    // The guarded group ends in a phi that the access reads
+    const auto phis = ssa.GetGroupPhis(1);
+    REQUIRE(phis.size() == 1);
+
+    const auto& phi = ssa.GetValue(*phis.begin());
+    CHECK(phi.Kind == SSAForm::Value::KIND::Phi);
+    CHECK(phi.Variable == index);
+    CHECK(phi.Previous == *ssa.GetActionDefinitions(0).begin());
+    CHECK(phi.Incoming == *ssa.GetActionDefinitions(2).begin());
+
+    const auto reads = ssa.GetActionReads(3);
+    CHECK(std::find(reads.begin(), reads.end(), *phis.begin()) != reads.end());
+
+    std::vector<FoundProblem> problems;
+    Analyzer analyzer(problems);
+    REQUIRE(analyzer.BeginAnalysis(block, nullptr, {}));
+
+    REQUIRE(problems.size() == 1);
+    CHECK(problems[0].Message == "Buffer overflow: buffer size: 3 used index: 5");
+}
+
+TEST_CASE("Actions that don't feed a sink are dead", "[ssa]")
+{
+    const VariableIdentifier index("ssa_live_index");
+    const VariableIdentifier unrelated("ssa_unrelated");
+    const VariableIdentifier flag("ssa_flag");
+    const VariableIdentifier buffer("ssa_live_buffer");
+    const Condition guard(
+        VariableValueCondition(flag, ValueRange(ValueRange::RANGE_CLASS::NotZero)));
+
+    CodeBlock block("ssa_live_test", clang::SourceLocation{});
+
+    block.AddProcessedAction(
+        Condition(), action::VarDeclared{index, VariableState(PrimitiveInfo(1))});
+    block.AddProcessedAction(
+        Condition(), action::VarDeclared{unrelated, VariableState(VarCopyInfo(index))});
+    block.AddProcessedAction(
+        Condition(), action::VarDeclared{buffer, VariableState(BufferInfo(3))});
+    block.AddProcessedAction(
+        guard, action::VarAssigned{unrelated, VariableState(PrimitiveInfo(2))});
+    block.EndActionGroup();
+    block.AddProcessedAction(
+        Condition(), action::ArrayIndexAccess{buffer, VariableState(VarCopyInfo(index))});
+
+    block.BuildSSA();
+    const SSAForm& ssa = *block.GetSSA();
+
+    CHECK(ssa.IsActionLive(0));
+    CHECK(!ssa.IsActionLive(1));
+    CHECK(ssa.IsActionLive(2));
+    CHECK(!ssa.IsActionLive(3));
+    CHECK(ssa.IsActionLive(4));
+
+    // Nothing live depends on the guard of the unrelated write
+    CHECK(ssa.IsGroupLive(0));
+    CHECK(!ssa.IsGroupLive(1));
+}
@@ -0,0 +1,123 @@
+// Tests for VariableState storage and the expression arena
+#include "catch.hpp"
+
+#include "parse/Condition.h"
+#include "parse/ExpressionArena.h"
+#include "parse/Variable.h"
+
+using namespace smacpp;
+
+namespace {
+
+class NoValues : public VariableValueProvider {
+public:
+    VariableState GetVariableValue(const VariableIdentifier& variable) const override
+    {
+        return VariableState();
+    }
+
+    VariableState GetVariableValueRaw(const VariableIdentifier& variable) const override
+    {
+        return VariableState();
+    }
+};
+
+} // namespace
+
+TEST_CASE("VariableState round trips stored values", "[variable]")
+{
+    const VariableState integer(PrimitiveInfo(-42));
+    REQUIRE(integer.State == VariableState::STATE::Primitive);
+    CHECK(integer.GetPrimitive().AsInteger() == -42);
+
+    const VariableState buffer(BufferInfo(16));
+    REQUIRE(buffer.State == VariableState::STATE::Buffer);
+    CHECK(buffer.GetBuffer().AllocatedSize == 16);
+    CHECK(!buffer.GetBuffer().NullPtr);
+    CHECK(VariableState(BufferInfo(nullptr)).GetBuffer().NullPtr);
+
+    const VariableIdentifier source("test_source");
+    const VariableState copy{VarCopyInfo(source)};
+    REQUIRE(copy.State == VariableState::STATE::CopyVar);
+    CHECK(copy.GetCopy().Source == source);
+
+    CHECK(VariableState() == VariableState());
+    CHECK(integer != VariableState(PrimitiveInfo(42)));
+    CHECK(integer.Hash() == VariableState(PrimitiveInfo(-42)).Hash());
+}
+
+TEST_CASE("Equal expressions are interned only once", "[variable]")
+{
+    const VariableState a{VarCopyInfo(VariableIdentifier("test_a"))};
+    const VariableState b{VarCopyInfo(VariableIdentifier("test_b"))};
+
+    const VariableState first(ComputeInfo(a, OPERATOR::Add, b));
+    const VariableState second(ComputeInfo(a, OPERATOR::Add, b));
+    const VariableState swapped(ComputeInfo(b, OPERATOR::Add, a));
+
+    CHECK(first == second);
+    CHECK(first.GetExpressionID() == second.GetExpressionID());
+    CHECK(first != swapped);
+
+    // Nested expressions share their sub-expressions
+    const VariableState nested(ComputeInfo(first, OPERATOR::Multiply, a));
+    const VariableState nestedAgain(ComputeInfo(second, OPERATOR::Multiply, a));
+    CHECK(nested == nestedAgain);
+    CHECK(nested.GetCompute().LHS == first);
+
+    CHECK(std::hash<ComputeInfo>()(ComputeInfo(a, OPERATOR::Add, b)) !=
+          std::hash<ComputeInfo>()(ComputeInfo(a, OPERATOR::Add, a)));
+}
+
+TEST_CASE("Intervals are stored inline and follow C arithmetic", "[variable]")
+{
+    const VariableState small(IntervalInfo(PRIMITIVE_TYPE::Int32, -3, 10));
+    REQUIRE(small.State == VariableState::STATE::Range);
+    CHECK(small.GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int32, -3, 10));
+    CHECK(small.IsNonZero() == TRI_STATE::Unknown);
+
+    const VariableState wide(IntervalInfo(PRIMITIVE_TYPE::Int64, INT64_MIN, 1LL << 40));
+    CHECK(wide.GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int64, INT64_MIN, 1LL << 40));
+
+    // A single value is a primitive
+    CHECK(VariableState(IntervalInfo(PRIMITIVE_TYPE::Int32, 7, 7)) ==
+          VariableState(PrimitiveInfo(PRIMITIVE_TYPE::Int32, 7)));
+
+    const VariableState one(PrimitiveInfo(PRIMITIVE_TYPE::Int32, 1));
+    const VariableState two(PrimitiveInfo(PRIMITIVE_TYPE::Int32, 2));
+    const auto joined = VariableState::Join(one, two);
+    REQUIRE(joined.State == VariableState::STATE::Range);
+    CHECK(joined.GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int32, 1, 2));
+    CHECK(VariableState::Join(one, VariableState(BufferInfo(1))).State ==
+          VariableState::STATE::Unknown);
+
+    // Widening moves the growing bound to the limit of the type
+    CHECK(VariableState::Widen(joined, one) == joined);
+    CHECK(VariableState::Widen(joined, VariableState(PrimitiveInfo(PRIMITIVE_TYPE::Int32, 3)))
+              .GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int32, 1, INT32_MAX));
+
+    const auto computed = VariableState::PerformComputation(
+        ComputeInfo(small, OPERATOR::Multiply, two), NoValues());
+    REQUIRE(computed.State == VariableState::STATE::Range);
+    CHECK(computed.GetInterval() == IntervalInfo(PRIMITIVE_TYPE::Int32, -6, 20));
+
+    // Results that can wrap around are unknown
+    const VariableState byte(IntervalInfo(PRIMITIVE_TYPE::UInt8, 200, 250));
+    CHECK(VariableState::PerformComputation(ComputeInfo(byte, OPERATOR::Add, byte), NoValues())
+              .State == VariableState::STATE::Range);
+    CHECK(VariableState::PerformComputation(
+              ComputeInfo(small, OPERATOR::Multiply, VariableState(PrimitiveInfo(1LL << 62))),
+              NoValues())
+              .State == VariableState::STATE::Unknown);
+
+    CHECK(small.Compare(COMPARISON::LESS_THAN, VariableState(PrimitiveInfo(11))) ==
+          TRI_STATE::True);
+    CHECK(small.Compare(COMPARISON::LESS_THAN, VariableState(PrimitiveInfo(5))) ==
+          TRI_STATE::Unknown);
+    CHECK(small.Compare(COMPARISON::EQUAL, VariableState(PrimitiveInfo(-4))) ==
+          TRI_STATE::False);
+
+    // Negative values compared as unsigned wrap around so the bounds don't tell anything
+    CHECK(small.Compare(COMPARISON::LESS_THAN,
+              VariableState(PrimitiveInfo(PRIMITIVE_TYPE::UInt32, 11))) == TRI_STATE::Unknown);
+}